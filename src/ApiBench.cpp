@@ -0,0 +1,142 @@
+#include "ApiBench.h"
+#include "GameApi.h"
+#include "NameIndex.h"
+
+// Keeps the compiler from dropping work whose results are unused
+static volatile uint32_t benchSink;
+
+// Serves ["Name00000","Name00001",...] byte by byte, without storing it
+class NameListStream : public Stream
+{
+public:
+    NameListStream(uint32_t names) : _names(names), _name(0), _pos(0), _sent(0) { fill(); }
+
+    int available() override { return _pos < _chunk.length() ? 1 : 0; }
+    int peek() override { return _pos < _chunk.length() ? _chunk[_pos] : -1; }
+    int read() override
+    {
+        int c = peek();
+        if (c >= 0 && ++_pos == _chunk.length())
+        {
+            fill();
+        }
+        _sent += c >= 0;
+        return c;
+    }
+    size_t write(uint8_t) override { return 0; }
+
+    uint32_t sent() const { return _sent; }
+
+    // Body length for a list of this many names, each "NameNNNNN" with its quotes and separator
+    static_assert(API_BENCH_MAX_NAMES <= 100000, "names past five digits change the body length");
+    static uint32_t length(uint32_t names) { return names == 0 ? 3 : names * 12 + 2; }
+
+private:
+    // Next piece of the array: the opening bracket, a name with its separator, or the end
+    void fill()
+    {
+        _pos = 0;
+        if (_name >= max(_names, (uint32_t)1))
+        {
+            _chunk = "";
+            return;
+        }
+        char piece[24]; // "[" "Name" + ten digits, quotes, "]\n": room for any uint32_t
+        if (_names == 0)
+        {
+            strcpy(piece, "[]\n");
+        }
+        else
+        {
+            snprintf(piece, sizeof(piece), "%s\"Name%05lu\"%s", _name == 0 ? "[" : "", (unsigned long)_name,
+                     _name + 1 == _names ? "]\n" : ",");
+        }
+        _chunk = piece;
+        _name++;
+    }
+
+    uint32_t _names;
+    uint32_t _name; // next name to serve
+    String _chunk;
+    unsigned int _pos;
+    uint32_t _sent;
+};
+
+static bool countName(JsonVariantConst element, void *context)
+{
+    const char *name = element.as<const char *>();
+    if (name == nullptr)
+    {
+        return false;
+    }
+    benchSink += NameIndex::hash(name, strlen(name));
+    (*(uint32_t *)context)++;
+    return true;
+}
+
+ApiBenchResult runApiBench(uint32_t names)
+{
+    ApiBenchResult result;
+    memset(&result, 0, sizeof(result));
+    result.names = constrain(names, (uint32_t)0, (uint32_t)API_BENCH_MAX_NAMES);
+    result.bodyBytes = NameListStream::length(result.names);
+
+    {
+        NameListStream body(result.names);
+        uint32_t heapBefore = ESP.getFreeHeap();
+        apiJsonBudget.resetPeak();
+        size_t jsonBefore = apiJsonBudget.used();
+        unsigned long start = millis();
+        result.streamOk = readJsonArray(body, countName, &result.streamNames);
+        result.streamMs = millis() - start;
+        result.streamJsonPeak = apiJsonBudget.peak() - jsonBefore;
+        result.streamHeapDelta = (int32_t)heapBefore - (int32_t)ESP.getFreeHeap();
+    }
+
+    // The old way needs one block the size of the body, plus room while the String grows
+    if (ESP.getMaxAllocHeap() > result.bodyBytes * 2 + API_BENCH_HEAP_MARGIN)
+    {
+        NameListStream body(result.names);
+        unsigned long start = millis();
+        String response;
+        response.reserve(result.bodyBytes);
+        int c;
+        while ((c = body.read()) >= 0)
+        {
+            response += (char)c;
+        }
+        result.bufferedFound = response.indexOf("\"Name00000\"") != -1;
+        result.bufferedMs = millis() - start;
+        result.bufferedBytes = response.length();
+        result.bufferedRun = true;
+    }
+
+    Serial.print("[runApiBench] ");
+    Serial.print(result.names);
+    Serial.print(" names, streamed in ");
+    Serial.print(result.streamMs);
+    Serial.print(" ms with ");
+    Serial.print(result.streamJsonPeak);
+    Serial.print(" JSON bytes, buffered ");
+    Serial.println(result.bufferedRun ? String(result.bufferedBytes) + " bytes" : String("skipped"));
+    return result;
+}
+
+String apiBenchJson(const ApiBenchResult &result)
+{
+    String json = "{";
+    json += "\"names\":" + String(result.names) + ",";
+    json += "\"bodyBytes\":" + String(result.bodyBytes) + ",";
+    json += "\"streamed\":{";
+    json += "\"ok\":" + String(result.streamOk ? "true" : "false") + ",";
+    json += "\"names\":" + String(result.streamNames) + ",";
+    json += "\"ms\":" + String(result.streamMs) + ",";
+    json += "\"jsonPeakBytes\":" + String(result.streamJsonPeak) + ",";
+    json += "\"heapDelta\":" + String(result.streamHeapDelta) + "},";
+    json += "\"buffered\":{";
+    json += "\"run\":" + String(result.bufferedRun ? "true" : "false") + ",";
+    json += "\"found\":" + String(result.bufferedFound ? "true" : "false") + ",";
+    json += "\"ms\":" + String(result.bufferedMs) + ",";
+    json += "\"heapBytes\":" + String(result.bufferedBytes) + "}}";
+    return json;
+}
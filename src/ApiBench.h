@@ -0,0 +1,37 @@
+// ApiBench.h
+#ifndef APIBENCH_H
+#define APIBENCH_H
+
+#include <Arduino.h>
+
+#define API_BENCH_NAMES 5000       // Names in the synthetic list
+#define API_BENCH_MAX_NAMES 50000  // Cap for ?n=
+#define API_BENCH_HEAP_MARGIN 32768 // Free block kept back when trying the buffered read
+
+struct ApiBenchResult
+{
+    uint32_t names;
+    uint32_t bodyBytes;
+
+    // Streamed: readJsonArray() over the body, as NameIndex refreshes
+    bool streamOk;
+    uint32_t streamNames; // names that came through
+    uint32_t streamMs;
+    uint32_t streamJsonPeak; // most JSON heap in use at once
+    int32_t streamHeapDelta; // free heap lost across the run, should stay 0
+
+    // Buffered: the whole body into a String, then indexOf(), as before
+    bool bufferedRun; // skipped when the heap has no block big enough
+    bool bufferedFound;
+    uint32_t bufferedMs;
+    uint32_t bufferedBytes; // String held at once
+};
+
+// Compares streaming a large get_custom_names response with buffering it.
+// A local stand-in plays the server: a Stream that generates a JSON array
+// of n names on the fly, so the list is never held in memory by the bench
+// itself and any size can be served. Run from /apiBench?n=.
+ApiBenchResult runApiBench(uint32_t names = API_BENCH_NAMES);
+String apiBenchJson(const ApiBenchResult &result);
+
+#endif // APIBENCH_H
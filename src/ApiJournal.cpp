@@ -0,0 +1,473 @@
+#include "ApiJournal.h"
+#include "NetWorker.h"
+#include <WiFi.h>
+#include <SPIFFS.h>
+#include <Preferences.h>
+
+#define JOURNAL_MAGIC 0xA5
+#define JOURNAL_HEADER 10 // magic, kind, seq[4], length[2], crc[2]
+
+ApiJournal apiJournal;
+
+// CRC-16/CCITT-FALSE, continued across calls
+static uint16_t crcUpdate(uint16_t crc, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static const char *kindPath(JournalKind kind)
+{
+    return kind == JournalKind::CreateCreature ? "/api/v1/create_user_from_rfid" : "/api/v1/add_5_coin";
+}
+
+ApiJournal::ApiJournal()
+    : _count(0), _heldCount(0), _fileBytes(0), _compactedBytes(0), _torn(false), _renamePending(false),
+      _compactFailedAt(0), _compactWaitMs(0), _inFlight(false), _nextSeq(0), _reservedSeq(0), _attempts(0),
+      _lastAttemptAt(0), _waitMs(0), _enqueued(0), _delivered(0), _rejected(0), _retries(0), _dropped(0), _replayed(0),
+      _compactions(0), _compactFailures(0), _maxEnqueueUs(0), _headSince(0)
+{
+    _unit[0] = '\0';
+}
+
+void ApiJournal::begin()
+{
+    uint64_t mac = ESP.getEfuseMac();
+    snprintf(_unit, sizeof(_unit), "%06lx", (unsigned long)((mac >> 24) & 0xFFFFFF));
+
+    Preferences prefs;
+    prefs.begin("journal", true);
+    _nextSeq = prefs.getUInt("seq", 0);
+    prefs.end();
+
+    // Power was lost between removing the old file and renaming the new one
+    if (!SPIFFS.exists(JOURNAL_PATH) && SPIFFS.exists(JOURNAL_TMP_PATH))
+    {
+        SPIFFS.rename(JOURNAL_TMP_PATH, JOURNAL_PATH);
+    }
+    replay();
+    reserveSeq();
+    _headSince = millis();
+
+    Serial.println("[ApiJournal] " + String(_count) + " mutations waiting to be sent");
+}
+
+void ApiJournal::reserveSeq()
+{
+    _reservedSeq = _nextSeq + JOURNAL_SEQ_RESERVE;
+    Preferences prefs;
+    prefs.begin("journal", false);
+    prefs.putUInt("seq", _reservedSeq);
+    prefs.end();
+}
+
+void ApiJournal::replay()
+{
+    _count = 0;
+    _fileBytes = 0;
+    File file = SPIFFS.open(JOURNAL_PATH, FILE_READ);
+    if (!file)
+    {
+        return;
+    }
+
+    uint32_t size = file.size();
+    uint8_t header[JOURNAL_HEADER];
+    uint8_t payload[JOURNAL_MAX_PAYLOAD];
+    bool torn = false;
+    while (_fileBytes < size)
+    {
+        if (file.read(header, JOURNAL_HEADER) != JOURNAL_HEADER || header[0] != JOURNAL_MAGIC)
+        {
+            torn = true;
+            break;
+        }
+        JournalKind kind = (JournalKind)header[1];
+        uint32_t seq = header[2] | (header[3] << 8) | ((uint32_t)header[4] << 16) | ((uint32_t)header[5] << 24);
+        uint16_t length = header[6] | (header[7] << 8);
+        uint16_t stored = header[8] | (header[9] << 8);
+        if (length > JOURNAL_MAX_PAYLOAD || file.read(payload, length) != length ||
+            crcUpdate(crcUpdate(0xFFFF, header, 8), payload, length) != stored)
+        {
+            torn = true;
+            break;
+        }
+
+        if (kind == JournalKind::Ack)
+        {
+            for (uint16_t i = 0; i < _count; i++)
+            {
+                if (_entries[i].seq == seq)
+                {
+                    memmove(_entries + i, _entries + i + 1, (_count - i - 1) * sizeof(Entry));
+                    _count--;
+                    break;
+                }
+            }
+        }
+        else if (_count < JOURNAL_MAX_PENDING)
+        {
+            _entries[_count++] = {seq, _fileBytes + JOURNAL_HEADER, length, kind};
+        }
+        else
+        {
+            _dropped++;
+        }
+        _nextSeq = max(_nextSeq, seq + 1);
+        _fileBytes += JOURNAL_HEADER + length;
+    }
+    file.close();
+
+    _replayed = _count;
+    if (torn)
+    {
+        Serial.println("[ApiJournal] Torn record at " + String(_fileBytes) + ", compacting");
+        _torn = true;
+        compact();
+    }
+}
+
+bool ApiJournal::append(JournalKind kind, uint32_t seq, const uint8_t *payload, uint16_t length)
+{
+    uint8_t record[JOURNAL_HEADER + JOURNAL_MAX_PAYLOAD];
+    record[0] = JOURNAL_MAGIC;
+    record[1] = (uint8_t)kind;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        record[2 + i] = (seq >> (8 * i)) & 0xFF;
+    }
+    record[6] = length & 0xFF;
+    record[7] = length >> 8;
+    if (length > 0)
+    {
+        memcpy(record + JOURNAL_HEADER, payload, length);
+    }
+    uint16_t crc = crcUpdate(crcUpdate(0xFFFF, record, 8), payload, length);
+    record[8] = crc & 0xFF;
+    record[9] = crc >> 8;
+
+    // One write per record, so a power cut tears at most the last one
+    File file = SPIFFS.open(JOURNAL_PATH, FILE_APPEND);
+    if (!file)
+    {
+        return false;
+    }
+    size_t size = JOURNAL_HEADER + length;
+    bool ok = file.write(record, size) == size;
+    file.close();
+    if (ok)
+    {
+        _fileBytes += size;
+    }
+    return ok;
+}
+
+bool ApiJournal::readPayload(const Entry &entry, char *payload)
+{
+    File file = SPIFFS.open(_renamePending ? JOURNAL_TMP_PATH : JOURNAL_PATH, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+    bool ok = file.seek(entry.offset) && file.read((uint8_t *)payload, entry.length) == entry.length;
+    file.close();
+    payload[ok ? entry.length : 0] = '\0';
+    return ok;
+}
+
+// Rewrite the file with only the mutations still waiting, under their
+// original sequence numbers, so their idempotency keys do not change
+bool ApiJournal::compact()
+{
+    _compactions++;
+    if (_renamePending)
+    {
+        // The last rewrite is complete under the tmp name; only its rename failed
+        if (!SPIFFS.rename(JOURNAL_TMP_PATH, JOURNAL_PATH))
+        {
+            return false;
+        }
+        _renamePending = false;
+    }
+    if (_count == 0)
+    {
+        SPIFFS.remove(JOURNAL_PATH);
+        _torn = SPIFFS.exists(JOURNAL_PATH);
+        _fileBytes = _compactedBytes = 0;
+        return !_torn;
+    }
+
+    File in = SPIFFS.open(JOURNAL_PATH, FILE_READ);
+    File out = SPIFFS.open(JOURNAL_TMP_PATH, FILE_WRITE);
+    if (!in || !out)
+    {
+        Serial.println("[ApiJournal] Compaction could not open the journal");
+        return false;
+    }
+
+    uint8_t payload[JOURNAL_MAX_PAYLOAD];
+    uint8_t header[JOURNAL_HEADER];
+    uint32_t offsets[JOURNAL_MAX_PENDING]; // applied only once the new file is complete
+    uint32_t written = 0;
+    bool ok = true;
+    for (uint16_t i = 0; ok && i < _count; i++)
+    {
+        const Entry &entry = _entries[i];
+        ok = in.seek(entry.offset) && in.read(payload, entry.length) == entry.length;
+
+        header[0] = JOURNAL_MAGIC;
+        header[1] = (uint8_t)entry.kind;
+        for (uint8_t b = 0; b < 4; b++)
+        {
+            header[2 + b] = (entry.seq >> (8 * b)) & 0xFF;
+        }
+        header[6] = entry.length & 0xFF;
+        header[7] = entry.length >> 8;
+        uint16_t crc = crcUpdate(crcUpdate(0xFFFF, header, 8), payload, entry.length);
+        header[8] = crc & 0xFF;
+        header[9] = crc >> 8;
+
+        ok = ok && out.write(header, JOURNAL_HEADER) == JOURNAL_HEADER &&
+             out.write(payload, entry.length) == entry.length;
+        offsets[i] = written + JOURNAL_HEADER;
+        written += JOURNAL_HEADER + entry.length;
+    }
+    in.close();
+    out.close();
+
+    if (!ok)
+    {
+        SPIFFS.remove(JOURNAL_TMP_PATH);
+        Serial.println("[ApiJournal] Compaction failed, keeping the old file");
+        return false;
+    }
+    // SPIFFS cannot rename over a file. If the rename fails the records are
+    // read from the tmp name until a retry, or begin() after a reboot, moves it.
+    SPIFFS.remove(JOURNAL_PATH);
+    _renamePending = !SPIFFS.rename(JOURNAL_TMP_PATH, JOURNAL_PATH);
+    for (uint16_t i = 0; i < _count; i++)
+    {
+        _entries[i].offset = offsets[i];
+    }
+    _fileBytes = _compactedBytes = written;
+    if (_renamePending)
+    {
+        Serial.println("[ApiJournal] Compaction could not rename the new file");
+        return false; // still torn, so nothing is appended to the tmp file
+    }
+    _torn = false;
+    return true;
+}
+
+bool ApiJournal::enqueue(JournalKind kind, const String &payload)
+{
+    unsigned long start = micros();
+    if (_count + _heldCount >= JOURNAL_MAX_PENDING || payload.length() > JOURNAL_MAX_PAYLOAD)
+    {
+        _dropped++;
+        Serial.println("[ApiJournal] Dropped " + String(kindPath(kind)) + ": journal full or payload too long");
+        return false;
+    }
+
+    if (_nextSeq >= _reservedSeq)
+    {
+        reserveSeq(); // once per JOURNAL_SEQ_RESERVE taps
+    }
+    uint32_t seq = _nextSeq++;
+    uint16_t length = payload.length();
+    bool ok;
+    // Anything appended behind a partial record would be lost on replay, so
+    // it waits for poll() to rewrite the file, off the tap path
+    if (_torn || _heldCount > 0)
+    {
+        ok = hold(kind, seq, payload.c_str(), length);
+    }
+    else if (!append(kind, seq, (const uint8_t *)payload.c_str(), length))
+    {
+        Serial.println("[ApiJournal] Flash append failed");
+        _torn = true; // the next poll() drops any partial record
+        ok = hold(kind, seq, payload.c_str(), length);
+    }
+    else
+    {
+        addEntry(seq, kind, length);
+        ok = true;
+    }
+
+    if (ok)
+    {
+        _enqueued++;
+    }
+    _maxEnqueueUs = max(_maxEnqueueUs, (uint32_t)(micros() - start));
+    return ok;
+}
+
+// The record just appended joins the pending list
+void ApiJournal::addEntry(uint32_t seq, JournalKind kind, uint16_t length)
+{
+    _entries[_count++] = {seq, _fileBytes - length, length, kind};
+    if (_count == 1)
+    {
+        _attempts = 0;
+        _waitMs = 0;
+        _headSince = millis();
+    }
+}
+
+bool ApiJournal::hold(JournalKind kind, uint32_t seq, const char *payload, uint16_t length)
+{
+    if (_heldCount == JOURNAL_HOLD)
+    {
+        _dropped++;
+        Serial.println("[ApiJournal] Dropped " + String(kindPath(kind)) + ": journal waiting for a rewrite");
+        return false;
+    }
+    Held &held = _held[_heldCount++];
+    held.seq = seq;
+    held.length = length;
+    held.kind = kind;
+    memcpy(held.payload, payload, length);
+    return true;
+}
+
+// After a rewrite: append what was held, oldest first, so sending order stays
+void ApiJournal::flushHeld()
+{
+    uint8_t done = 0;
+    while (done < _heldCount)
+    {
+        const Held &held = _held[done];
+        if (!append(held.kind, held.seq, (const uint8_t *)held.payload, held.length))
+        {
+            _torn = true; // the rest waits for the next rewrite
+            break;
+        }
+        addEntry(held.seq, held.kind, held.length);
+        done++;
+    }
+    memmove(_held, _held + done, (_heldCount - done) * sizeof(Held));
+    _heldCount -= done;
+}
+
+void ApiJournal::finishHead(bool delivered)
+{
+    uint32_t seq = _entries[0].seq;
+    memmove(_entries, _entries + 1, (_count - 1) * sizeof(Entry));
+    _count--;
+    if (delivered)
+    {
+        _delivered++;
+    }
+    else
+    {
+        _rejected++;
+    }
+    // While the file is torn the Ack would be lost on replay; the rewrite
+    // in poll() leaves the mutation out just the same
+    if (_torn || !append(JournalKind::Ack, seq, nullptr, 0))
+    {
+        _torn = true;
+    }
+    _attempts = 0;
+    _waitMs = 0;
+    _headSince = millis();
+}
+
+void ApiJournal::poll(bool idle)
+{
+    bool wanted = _torn || (_count == 0 && _fileBytes > 0) || _fileBytes - _compactedBytes > JOURNAL_COMPACT_BYTES;
+    if (idle && wanted && millis() - _compactFailedAt >= _compactWaitMs)
+    {
+        if (compact())
+        {
+            _compactWaitMs = 0;
+            flushHeld();
+        }
+        else
+        {
+            // A full or failing flash would otherwise be rewritten on every pass
+            _compactFailures++;
+            _compactFailedAt = millis();
+            _compactWaitMs = _compactWaitMs ? min(_compactWaitMs * 2, JOURNAL_BACKOFF_MAX_MS) : JOURNAL_COMPACT_RETRY_MS;
+            Serial.println("[ApiJournal] Compaction failed, retry in " + String(_compactWaitMs) + " ms");
+        }
+    }
+    if (_count == 0 || _inFlight || WiFi.status() != WL_CONNECTED || millis() - _lastAttemptAt < _waitMs)
+    {
+        return;
+    }
+
+    const Entry &head = _entries[0];
+    NetRequest request;
+    request.kind = NetRequestKind::Mutation;
+    request.id = head.seq;
+    request.path = kindPath(head.kind);
+    snprintf(request.key, sizeof(request.key), "%s-%lu", _unit, (unsigned long)head.seq);
+    if (!readPayload(head, request.payload))
+    {
+        Serial.println("[ApiJournal] Could not read mutation " + String(head.seq) + ", dropping it");
+        finishHead(false);
+        return;
+    }
+
+    _lastAttemptAt = millis();
+    _inFlight = netWorker.submit(request);
+}
+
+void ApiJournal::complete(uint32_t seq, int status)
+{
+    _inFlight = false;
+    if (_count == 0 || _entries[0].seq != seq)
+    {
+        return;
+    }
+
+    if (status / 100 == 2)
+    {
+        finishHead(true);
+        return;
+    }
+    if (status >= 400 && status < 500 && status != 408 && status != 429)
+    {
+        // The server understood and refused; sending it again will not help
+        Serial.println("[ApiJournal] " + String(kindPath(_entries[0].kind)) + " rejected: " + String(status));
+        finishHead(false);
+        return;
+    }
+
+    _retries++;
+    _waitMs = min(JOURNAL_BACKOFF_MS << min(_attempts, (uint8_t)12), JOURNAL_BACKOFF_MAX_MS);
+    _waitMs += esp_random() % (_waitMs / 4 + 1); // units recovering together don't retry in step
+    _lastAttemptAt = millis();
+    _attempts++;
+    Serial.println("[ApiJournal] Send failed (" + String(status) + "), retry " + String(_attempts) + " in " +
+                   String(_waitMs) + " ms");
+}
+
+String ApiJournal::statsJson() const
+{
+    String json = "{";
+    json += "\"pending\":" + String(_count) + ",";
+    json += "\"held\":" + String(_heldCount) + ",";
+    json += "\"fileBytes\":" + String(_fileBytes) + ",";
+    json += "\"enqueued\":" + String(_enqueued) + ",";
+    json += "\"delivered\":" + String(_delivered) + ",";
+    json += "\"rejected\":" + String(_rejected) + ",";
+    json += "\"retries\":" + String(_retries) + ",";
+    json += "\"dropped\":" + String(_dropped) + ",";
+    json += "\"replayed\":" + String(_replayed) + ",";
+    json += "\"compactions\":" + String(_compactions) + ",";
+    json += "\"compactFailures\":" + String(_compactFailures) + ",";
+    json += "\"maxEnqueueUs\":" + String(_maxEnqueueUs) + ",";
+    json += "\"attempts\":" + String(_attempts) + ",";
+    json += "\"headAgeS\":" + String(_count ? (millis() - _headSince) / 1000 : 0) + ",";
+    json += "\"nextSeq\":" + String(_nextSeq) + "}";
+    return json;
+}
@@ -0,0 +1,126 @@
+// ApiJournal.h
+#ifndef APIJOURNAL_H
+#define APIJOURNAL_H
+
+#include <Arduino.h>
+
+#define JOURNAL_PATH "/journal.log"
+#define JOURNAL_TMP_PATH "/journal.tmp"
+#define JOURNAL_MAX_PENDING 128       // Unsent mutations held; a tap past this is dropped and counted
+#define JOURNAL_MAX_PAYLOAD 256       // Bytes of JSON per mutation
+#define JOURNAL_COMPACT_BYTES 16384   // Rewrite the file once this much has been appended since the last rewrite
+#define JOURNAL_SEQ_RESERVE 64        // Sequence numbers reserved per NVS write
+#define JOURNAL_BACKOFF_MS 2000UL     // First retry delay, doubled per failed attempt
+#define JOURNAL_BACKOFF_MAX_MS 300000UL
+#define JOURNAL_HOLD 8                // Mutations held in RAM while the file waits for a rewrite
+#define JOURNAL_COMPACT_RETRY_MS 5000UL // First retry after a failed rewrite, doubled per failure
+
+enum class JournalKind : uint8_t
+{
+    CreateCreature = 1, // POST /api/v1/create_user_from_rfid
+    AddCoins = 2,       // POST /api/v1/add_5_coin
+    Ack = 0x7F          // the mutation with this sequence number is done
+};
+
+// Append-only journal in SPIFFS of every mutation the unit sends to the
+// game API. A tap only appends; poll() has the network worker send the
+// oldest unsent mutation, in order, and complete() appends an Ack once the
+// server has answered, so awards survive Wi-Fi or server outages and
+// reboots.
+//
+// Every mutation carries an Idempotency-Key, "<unit>-<sequence>", that
+// stays the same across retries and reboots so the server can drop a
+// repeat. Sequence numbers are reserved in NVS JOURNAL_SEQ_RESERVE at a
+// time, so a reboot skips some but never reuses one. A failed send waits
+// JOURNAL_BACKOFF_MS, doubled per attempt up to JOURNAL_BACKOFF_MAX_MS
+// with jitter. A 4xx other than 408/429 counts as rejected and is not
+// retried.
+//
+// Record: magic, kind, sequence (4 bytes LE), payload length (2 bytes
+// LE), CRC-16 over the rest, payload. Replay stops at the first torn or
+// corrupt record; the file is then compacted to the valid pending ones.
+// A failed append marks the file torn the same way. Mutations that arrive
+// before poll() has rewritten it wait in RAM, up to JOURNAL_HOLD, and are
+// appended after the rewrite; a failed rewrite is retried with backoff.
+class ApiJournal
+{
+public:
+    ApiJournal();
+
+    void begin(); // after SPIFFS is mounted: replay the file
+
+    // Record a mutation for sending; false if the journal is full or flash failed
+    bool enqueue(JournalKind kind, const String &payload);
+
+    // From loop(): hands the oldest mutation to the network worker when it
+    // is due, one at a time. Compaction waits for idle (no card on a pad).
+    void poll(bool idle);
+
+    // The network worker's answer for the mutation with this sequence number
+    void complete(uint32_t seq, int status);
+
+    uint16_t pending() const { return _count + _heldCount; }
+    String statsJson() const;
+
+private:
+    struct Entry
+    {
+        uint32_t seq;
+        uint32_t offset; // of the payload in the file
+        uint16_t length;
+        JournalKind kind;
+    };
+
+    // A mutation waiting for the file to be rewritten, sequence number already given
+    struct Held
+    {
+        uint32_t seq;
+        uint16_t length;
+        JournalKind kind;
+        char payload[JOURNAL_MAX_PAYLOAD];
+    };
+
+    bool append(JournalKind kind, uint32_t seq, const uint8_t *payload, uint16_t length);
+    bool readPayload(const Entry &entry, char *payload); // JOURNAL_MAX_PAYLOAD + 1 bytes
+    void replay();
+    bool compact();
+    void reserveSeq();
+    void addEntry(uint32_t seq, JournalKind kind, uint16_t length);
+    bool hold(JournalKind kind, uint32_t seq, const char *payload, uint16_t length);
+    void flushHeld();
+    void finishHead(bool delivered);
+
+    Entry _entries[JOURNAL_MAX_PENDING]; // oldest first
+    uint16_t _count;
+    Held _held[JOURNAL_HOLD]; // oldest first, all newer than _entries
+    uint8_t _heldCount;
+    uint32_t _fileBytes;
+    uint32_t _compactedBytes; // file size after the last compaction
+    bool _torn;               // the file ends in a partial record until compacted
+    bool _renamePending;      // the rewritten file is still under JOURNAL_TMP_PATH
+    unsigned long _compactFailedAt;
+    unsigned long _compactWaitMs; // backoff before the next rewrite
+    bool _inFlight;           // the oldest entry is with the network worker
+    uint32_t _nextSeq;
+    uint32_t _reservedSeq; // first sequence number not yet reserved in NVS
+    char _unit[7];         // low three MAC bytes in hex
+
+    uint8_t _attempts; // on the oldest entry
+    unsigned long _lastAttemptAt;
+    unsigned long _waitMs; // backoff before the next attempt
+
+    uint32_t _enqueued;
+    uint32_t _delivered;
+    uint32_t _rejected;
+    uint32_t _retries;
+    uint32_t _dropped;
+    uint32_t _replayed;
+    uint32_t _compactions;
+    uint32_t _compactFailures;
+    uint32_t _maxEnqueueUs;
+    unsigned long _headSince; // when the oldest entry reached the head
+};
+
+extern ApiJournal apiJournal;
+
+#endif // APIJOURNAL_H
@@ -0,0 +1,194 @@
+#include "CardDetect.h"
+#include "GlobalDefs.h"
+
+static int irqPin = IRQ_PIN;
+static TaskHandle_t waitingTask = nullptr;
+static volatile uint32_t irqMicros = 0;
+
+// IRQ edge -> card selected
+static uint32_t irqDetections = 0;
+static uint32_t lastLatencyUs = 0;
+static uint32_t maxLatencyUs = 0;
+static uint64_t totalLatencyUs = 0;
+
+// cardDetectPoll() state
+static bool irqArmed = false;
+static bool irqPending = false; // notification taken by cardDetectWait(), not yet handled
+static unsigned long lastArmOrPoll = 0;
+
+// Last poll per reader, so pads sharing the bus are each polled at the full rate
+struct PollSlot
+{
+    const MFRC522 *reader;
+    unsigned long lastPoll;
+};
+static PollSlot pollSlots[READER_COUNT];
+
+static unsigned long &lastPollFor(const MFRC522 &mfrc522)
+{
+    for (uint8_t i = 0; i < READER_COUNT; i++)
+    {
+        if (pollSlots[i].reader == &mfrc522 || pollSlots[i].reader == nullptr)
+        {
+            pollSlots[i].reader = &mfrc522;
+            return pollSlots[i].lastPoll;
+        }
+    }
+    return lastArmOrPoll;
+}
+
+static void IRAM_ATTR cardIrqHandler()
+{
+    irqMicros = micros();
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(waitingTask, &woken);
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Clear pending interrupt bits on the reader
+static void clearCardIrq(MFRC522 &mfrc522)
+{
+    mfrc522.PCD_WriteRegister(MFRC522::ComIrqReg, 0x7F);
+    mfrc522.PCD_WriteRegister(MFRC522::DivIrqReg, 0x7F);
+}
+
+// Enable the receive interrupt and send REQA so a card in the field answers
+static void armCardIrq(MFRC522 &mfrc522)
+{
+    clearCardIrq(mfrc522);
+    mfrc522.PCD_WriteRegister(MFRC522::ComIEnReg, 0xA0); // IRqInv | RxIEn
+    mfrc522.PCD_WriteRegister(MFRC522::FIFODataReg, MFRC522::PICC_CMD_REQA);
+    mfrc522.PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Transceive);
+    mfrc522.PCD_WriteRegister(MFRC522::BitFramingReg, 0x87); // StartSend, 7-bit frame
+}
+
+// Keep the IRQ line quiet while the card is being read/written
+static void disarmCardIrq(MFRC522 &mfrc522)
+{
+    mfrc522.PCD_WriteRegister(MFRC522::ComIEnReg, 0x80); // IRqInv only
+    clearCardIrq(mfrc522);
+}
+
+bool cardDetectUsesIrq()
+{
+    return irqPin >= 0 && READER_COUNT == 1;
+}
+
+uint32_t lastDetectLatencyUs()
+{
+    return lastLatencyUs;
+}
+
+String cardDetectStatsJson()
+{
+    String json = "{";
+    json += "\"irq\":" + String(cardDetectUsesIrq() ? "true" : "false") + ",";
+    json += "\"irqDetections\":" + String(irqDetections) + ",";
+    json += "\"lastLatencyUs\":" + String(lastLatencyUs) + ",";
+    json += "\"avgLatencyUs\":" + String(irqDetections ? (uint32_t)(totalLatencyUs / irqDetections) : 0) + ",";
+    json += "\"maxLatencyUs\":" + String(maxLatencyUs) + ",";
+    json += "\"pollIntervalMs\":" + String(cardDetectUsesIrq() ? 0 : CARD_POLL_INTERVAL_MS);
+    json += "}";
+    return json;
+}
+
+void cardDetectBegin(MFRC522 &mfrc522, int pin)
+{
+    irqPin = pin;
+    if (!cardDetectUsesIrq())
+    {
+        Serial.println("[cardDetect] No IRQ pin, polling for cards");
+        return;
+    }
+
+    waitingTask = xTaskGetCurrentTaskHandle();
+    pinMode(irqPin, INPUT_PULLUP);
+    disarmCardIrq(mfrc522);
+    attachInterrupt(digitalPinToInterrupt(irqPin), cardIrqHandler, FALLING);
+
+    // Drop any notification raised by a spurious edge while attaching
+    ulTaskNotifyTake(pdTRUE, 0);
+    Serial.println("[cardDetect] Using IRQ pin " + String(irqPin));
+}
+
+// The card answered our REQA and is READY, so go straight to select.
+// If that misses (e.g. noise on the line) try a normal REQA + select.
+static bool selectAfterIrq(MFRC522 &mfrc522)
+{
+    if (mfrc522.PICC_ReadCardSerial() ||
+        (mfrc522.PICC_IsNewCardPresent() && mfrc522.PICC_ReadCardSerial()))
+    {
+        lastLatencyUs = micros() - irqMicros;
+        maxLatencyUs = max(maxLatencyUs, lastLatencyUs);
+        totalLatencyUs += lastLatencyUs;
+        irqDetections++;
+        Serial.print("[cardDetect] IRQ to select (us): ");
+        Serial.println(lastLatencyUs);
+        return true;
+    }
+    return false;
+}
+
+void cardDetectDisarm(MFRC522 &mfrc522)
+{
+    if (irqArmed)
+    {
+        disarmCardIrq(mfrc522);
+        ulTaskNotifyTake(pdTRUE, 0);
+        irqArmed = irqPending = false;
+    }
+}
+
+void cardDetectWait(uint32_t maxMs)
+{
+    if (!cardDetectUsesIrq() || !irqArmed || irqPending)
+    {
+        delay(1);
+        return;
+    }
+    // The next REQA goes out CARD_IRQ_REARM_MS after the last; no card can answer sooner
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(min(maxMs, (uint32_t)CARD_IRQ_REARM_MS))) > 0)
+    {
+        irqPending = true;
+    }
+}
+
+bool cardDetectPoll(MFRC522 &mfrc522)
+{
+    unsigned long now = millis();
+
+    if (!cardDetectUsesIrq())
+    {
+        unsigned long &lastPoll = lastPollFor(mfrc522);
+        if (now - lastPoll < CARD_POLL_INTERVAL_MS)
+        {
+            return false;
+        }
+        lastPoll = now;
+        return mfrc522.PICC_IsNewCardPresent() && mfrc522.PICC_ReadCardSerial();
+    }
+
+    if (irqArmed && (irqPending || ulTaskNotifyTake(pdTRUE, 0) > 0))
+    {
+        disarmCardIrq(mfrc522);
+        irqArmed = irqPending = false;
+        if (selectAfterIrq(mfrc522))
+        {
+            return true;
+        }
+    }
+
+    if (!irqArmed || now - lastArmOrPoll >= CARD_IRQ_REARM_MS)
+    {
+        ulTaskNotifyTake(pdTRUE, 0);
+        irqPending = false;
+        armCardIrq(mfrc522);
+        irqArmed = true;
+        lastArmOrPoll = now;
+    }
+    return false;
+}
@@ -0,0 +1,36 @@
+// CardDetect.h
+#ifndef CARDDETECT_H
+#define CARDDETECT_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+
+// Card detection for the main loop.
+// With an IRQ pin wired (IRQ_PIN in GlobalDefs.h) the reader raises its IRQ
+// line when a card answers REQA and the ISR notifies the loop task. While
+// the pads are idle loop() sleeps on that notification in cardDetectWait()
+// instead of spinning, and cardDetectPoll() only checks it without
+// blocking. With no IRQ pin, or more than one reader, it falls back to
+// PICC_IsNewCardPresent() polling, rate-limited per reader.
+
+// Call after mfrc522.PCD_Init(), from the task that calls cardDetectPoll().
+// irqPin is the GPIO the reader's IRQ line is wired to, -1 to poll.
+void cardDetectBegin(MFRC522 &mfrc522, int irqPin);
+
+// Does at most one short reader operation per call and returns true once a
+// card has been selected (its UID is in mfrc522.uid).
+bool cardDetectPoll(MFRC522 &mfrc522);
+
+// Rest of a loop() round: blocks on the IRQ notification for up to maxMs
+// and returns as soon as a card answers; delay(1) when not waiting on the IRQ.
+void cardDetectWait(uint32_t maxMs);
+
+// Stop waiting on the IRQ so other code can talk to the card; the next
+// cardDetectPoll() re-arms it
+void cardDetectDisarm(MFRC522 &mfrc522);
+
+bool cardDetectUsesIrq();
+uint32_t lastDetectLatencyUs(); // IRQ edge -> card selected, 0 when polling
+String cardDetectStatsJson();   // IRQ detections and their latency, for /stats
+
+#endif // CARDDETECT_H
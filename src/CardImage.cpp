@@ -0,0 +1,284 @@
+#include "CardImage.h"
+#include <FS.h>
+#include <SPIFFS.h>
+
+static const byte imageMagic[4] = {'C', 'I', 'M', 'G'};
+
+static bool isUltralightType(byte piccType)
+{
+    return piccType == MFRC522::PICC_TYPE_MIFARE_UL;
+}
+
+static uint8_t classicBlockCount(byte piccType)
+{
+    switch (piccType)
+    {
+    case MFRC522::PICC_TYPE_MIFARE_MINI:
+        return 20; // 5 sectors
+    case MFRC522::PICC_TYPE_MIFARE_1K:
+    case MFRC522::PICC_TYPE_MIFARE_4K:
+        return CARD_IMAGE_MAX_BLOCKS;
+    default:
+        return 0;
+    }
+}
+
+bool dumpCard(MFRC522 &mfrc522, RFIDSession &session, CardImage &image)
+{
+    image.piccType = MFRC522::PICC_GetType(mfrc522.uid.sak);
+    image.uid = mfrc522.uid;
+    image.readMask = 0;
+    memset(image.blocks, 0, sizeof(image.blocks));
+
+    if (isUltralightType(image.piccType))
+    {
+        // Plain Ultralight NAKs past page 15, NTAG213 past page 44
+        image.blockCount = CARD_IMAGE_UL_BLOCKS;
+        for (byte block = 0; block < image.blockCount; block++)
+        {
+            if (!session.readBlock(block, image.blocks[block]))
+            {
+                break;
+            }
+            image.readMask |= 1ULL << block;
+        }
+    }
+    else
+    {
+        image.blockCount = classicBlockCount(image.piccType);
+        if (image.blockCount == 0)
+        {
+            Serial.println("[dumpCard] Unsupported card type");
+            return false;
+        }
+
+        for (byte block = 0; block < image.blockCount; block++)
+        {
+            if (session.readBlock(block, image.blocks[block]))
+            {
+                image.readMask |= 1ULL << block;
+                continue;
+            }
+
+            // Sector not readable with our key: the card dropped out of the
+            // session, so reselect it and carry on with the next sector
+            Serial.println("[dumpCard] Skipping sector " + String(block / 4));
+            if (!session.reselect())
+            {
+                Serial.println("[dumpCard] Card lost");
+                return false;
+            }
+            block |= 3; // Loop increment moves to the next sector
+        }
+    }
+
+    Serial.print("[dumpCard] Read ");
+    Serial.print(session.readCount());
+    Serial.print(" blocks with ");
+    Serial.print(session.authCount());
+    Serial.println(" auths");
+    return image.readMask != 0;
+}
+
+bool restoreCard(MFRC522 &mfrc522, RFIDSession &session, const CardImage &image)
+{
+    byte targetType = MFRC522::PICC_GetType(mfrc522.uid.sak);
+    if (isUltralightType(targetType) != isUltralightType(image.piccType))
+    {
+        Serial.println("[restoreCard] Image is for a different card family");
+        return false;
+    }
+
+    if (isUltralightType(targetType))
+    {
+        // Pages 0-3 hold the UID, lock bits and OTP area
+        for (byte block = 1; block < image.blockCount; block++)
+        {
+            if (!(image.readMask & (1ULL << block)))
+            {
+                continue;
+            }
+            byte current[16];
+            if (!session.readBlock(block, current) ||
+                !session.writeBlockIfChanged(block, image.blocks[block]))
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        if (image.blockCount > classicBlockCount(targetType))
+        {
+            Serial.println("[restoreCard] Image is larger than the card");
+            return false;
+        }
+
+        for (byte sector = 0; sector < image.blockCount / 4; sector++)
+        {
+            // Data blocks of this sector: 3, or 2 in sector 0 (block 0 is read-only)
+            BlockImage group[3];
+            uint8_t count = 0;
+            for (byte block = sector * 4; block < sector * 4 + 3; block++)
+            {
+                if (block == 0 || !(image.readMask & (1ULL << block)))
+                {
+                    continue;
+                }
+
+                // Reading first (same auth) lets commit() skip unchanged blocks,
+                // and a read is much cheaper than a write
+                byte current[16];
+                if (!session.readBlock(block, current))
+                {
+                    return false;
+                }
+                group[count].blockAddr = block;
+                memcpy(group[count].data, image.blocks[block], 16);
+                count++;
+            }
+            if (count > 0 && !session.commit(group, count))
+            {
+                return false;
+            }
+        }
+    }
+
+    Serial.print("[restoreCard] Auths: ");
+    Serial.print(session.authCount());
+    Serial.print(", blocks written/skipped: ");
+    Serial.print(session.writeCount());
+    Serial.print("/");
+    Serial.println(session.blocksSkipped());
+    return true;
+}
+
+String uidToHex(const MFRC522::Uid &uid)
+{
+    String hex;
+    for (byte i = 0; i < uid.size; i++)
+    {
+        if (uid.uidByte[i] < 0x10)
+        {
+            hex += "0";
+        }
+        hex += String(uid.uidByte[i], HEX);
+    }
+    hex.toUpperCase();
+    return hex;
+}
+
+String cardImagePath(const String &uidHex)
+{
+    return String(CARD_IMAGE_PREFIX) + uidHex + ".img";
+}
+
+bool saveCardImage(const CardImage &image)
+{
+    String path = cardImagePath(uidToHex(image.uid));
+    File file = SPIFFS.open(path, FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("[saveCardImage] Could not open " + path);
+        return false;
+    }
+
+    byte header[28];
+    memcpy(header, imageMagic, 4);
+    header[4] = CARD_IMAGE_VERSION;
+    header[5] = image.piccType;
+    header[6] = image.uid.size;
+    memcpy(header + 7, image.uid.uidByte, 10);
+    header[17] = image.blockCount;
+    for (byte i = 0; i < 8; i++)
+    {
+        header[18 + i] = (image.readMask >> (8 * i)) & 0xFF;
+    }
+    header[26] = header[27] = 0; // Reserved
+
+    bool ok = file.write(header, sizeof(header)) == sizeof(header);
+    for (byte block = 0; ok && block < image.blockCount; block++)
+    {
+        if (image.readMask & (1ULL << block))
+        {
+            ok = file.write(image.blocks[block], 16) == 16;
+        }
+    }
+    file.close();
+
+    Serial.println("[saveCardImage] " + path + (ok ? " saved" : " write failed"));
+    return ok;
+}
+
+bool loadCardImage(const String &uidHex, CardImage &image)
+{
+    String path = cardImagePath(uidHex);
+    File file = SPIFFS.open(path, FILE_READ);
+    if (!file)
+    {
+        Serial.println("[loadCardImage] No image " + path);
+        return false;
+    }
+
+    byte header[28];
+    bool ok = file.read(header, sizeof(header)) == sizeof(header) &&
+              memcmp(header, imageMagic, 4) == 0 &&
+              header[4] == CARD_IMAGE_VERSION &&
+              header[6] <= 10 &&
+              header[17] <= CARD_IMAGE_MAX_BLOCKS;
+    if (ok)
+    {
+        image.piccType = header[5];
+        image.uid.size = header[6];
+        memcpy(image.uid.uidByte, header + 7, 10);
+        image.blockCount = header[17];
+        image.readMask = 0;
+        for (byte i = 0; i < 8; i++)
+        {
+            image.readMask |= (uint64_t)header[18 + i] << (8 * i);
+        }
+        memset(image.blocks, 0, sizeof(image.blocks));
+        for (byte block = 0; ok && block < image.blockCount; block++)
+        {
+            if (image.readMask & (1ULL << block))
+            {
+                ok = file.read(image.blocks[block], 16) == 16;
+            }
+        }
+    }
+    file.close();
+
+    if (!ok)
+    {
+        Serial.println("[loadCardImage] Bad image " + path);
+    }
+    return ok;
+}
+
+String listCardImagesJson()
+{
+    String json = "[";
+    File root = SPIFFS.open("/");
+    File file = root.openNextFile();
+    bool first = true;
+    while (file)
+    {
+        String name = file.name();
+        // Depending on the core version the name may or may not start with '/'
+        const char *prefix = CARD_IMAGE_PREFIX + 1;
+        int start = name.indexOf(prefix);
+        if (start != -1 && name.endsWith(".img"))
+        {
+            String uidHex = name.substring(start + strlen(prefix), name.length() - 4);
+            if (!first)
+            {
+                json += ",";
+            }
+            json += "{\"uid\":\"" + uidHex + "\",\"bytes\":" + String(file.size()) + "}";
+            first = false;
+        }
+        file = root.openNextFile();
+    }
+    json += "]";
+    return json;
+}
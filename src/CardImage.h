@@ -0,0 +1,45 @@
+// CardImage.h
+#ifndef CARDIMAGE_H
+#define CARDIMAGE_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFIDSession.h"
+
+#define CARD_IMAGE_MAX_BLOCKS 64 // MIFARE Classic 1K; larger cards are cut at 64 blocks
+#define CARD_IMAGE_UL_BLOCKS 10  // Ultralight/NTAG213 pages 0-39 (user memory ends at 39)
+#define CARD_IMAGE_VERSION 1
+#define CARD_IMAGE_PREFIX "/card_" // SPIFFS is flat, so images live in the root
+
+// Every block that could be read from one card. blockCount is the card's
+// size in blocks; readMask marks which of them were readable (sectors whose
+// key is not the default are skipped).
+struct CardImage
+{
+    byte piccType; // MFRC522::PICC_Type
+    MFRC522::Uid uid;
+    uint8_t blockCount;
+    uint64_t readMask;
+    byte blocks[CARD_IMAGE_MAX_BLOCKS][16];
+};
+
+// Read the selected card sector by sector, one auth per sector
+bool dumpCard(MFRC522 &mfrc522, RFIDSession &session, CardImage &image);
+
+// Write an image back onto the selected card of the same family. Block 0,
+// sector trailers and Ultralight pages 0-3 are never written, so keys,
+// access bits and the target's UID stay as they are. Each sector is
+// authenticated once and its blocks read first, so only blocks that differ
+// from the target are written.
+bool restoreCard(MFRC522 &mfrc522, RFIDSession &session, const CardImage &image);
+
+// Flash storage, one file per card: CARD_IMAGE_PREFIX + UID in hex + ".img".
+// Layout: "CIMG", version, piccType, uid size, 10 uid bytes, blockCount,
+// readMask (8 bytes, little endian), then 16 bytes per readable block.
+bool saveCardImage(const CardImage &image);
+bool loadCardImage(const String &uidHex, CardImage &image);
+String cardImagePath(const String &uidHex);
+String uidToHex(const MFRC522::Uid &uid);
+String listCardImagesJson();
+
+#endif // CARDIMAGE_H
@@ -0,0 +1,144 @@
+#include "CardMigration.h"
+#include "RFIDData.h"
+#include <Preferences.h>
+
+CardMigrator cardMigrator;
+
+// Legacy ASCII names may hold characters outside the 6-bit alphabet, and a
+// two-digit creature type can exceed what the binary record stores
+static ProfileError asciiToV1(ProfileFields &fields)
+{
+    sanitizeProfileName(fields.name);
+    return validateProfile(fields);
+}
+
+// One step per version, indexed by the version it upgrades from. A new
+// record layout adds its step here, after its decoder in ProfileCodec.cpp.
+struct MigrationStep
+{
+    uint8_t from;
+    const char *name;
+    ProfileError (*apply)(ProfileFields &fields);
+};
+
+static const MigrationStep steps[PROFILE_VERSION_CURRENT] = {
+    {PROFILE_VERSION_ASCII, "ascii>v1", asciiToV1},
+};
+
+CardMigrator::CardMigrator()
+    : _migrated(0), _migratedTotal(0), _deferred(0), _blocked(0), _failed(0), _lastMs(0), _maxMs(0)
+{
+    memset(_seen, 0, sizeof(_seen));
+}
+
+void CardMigrator::begin()
+{
+    Preferences prefs;
+    prefs.begin("cardmig", true);
+    _migratedTotal = prefs.getUInt("migrated", 0);
+    prefs.end();
+}
+
+void CardMigrator::countMigrated()
+{
+    _migrated++;
+    _migratedTotal++;
+
+    // Once per card lifetime, so flash wear stays low
+    Preferences prefs;
+    prefs.begin("cardmig", false);
+    prefs.putUInt("migrated", _migratedTotal);
+    prefs.end();
+}
+
+MigrationOutcome CardMigrator::migrate(RFIDSession *session, byte *block, uint8_t fromVersion, unsigned long tapStart)
+{
+    if (fromVersion >= PROFILE_VERSION_COUNT)
+    {
+        return MigrationOutcome::Current; // blank, foreign or newer: nothing to do
+    }
+    _seen[fromVersion]++;
+    if (fromVersion == PROFILE_VERSION_CURRENT)
+    {
+        return MigrationOutcome::Current;
+    }
+    if (profileVersion(block) == PROFILE_VERSION_CURRENT)
+    {
+        countMigrated(); // the coin move already wrote the current version
+        return MigrationOutcome::Migrated;
+    }
+
+    unsigned long start = millis();
+    if (session == nullptr || start - tapStart + CARD_MIGRATION_WRITE_MS > CARD_MIGRATION_BUDGET_MS)
+    {
+        _deferred++;
+        return MigrationOutcome::Deferred;
+    }
+
+    ProfileFields fields;
+    if (decodeProfile(block, fields) != ProfileError::Ok)
+    {
+        return MigrationOutcome::Current; // not a profile; the tap already treated it as such
+    }
+    for (uint8_t version = fromVersion; version < PROFILE_VERSION_CURRENT; version++)
+    {
+        ProfileError error = steps[version].apply(fields);
+        if (error != ProfileError::Ok)
+        {
+            Serial.print("[CardMigrator] ");
+            Serial.print(steps[version].name);
+            Serial.print(" blocked: ");
+            Serial.println(profileErrorName(error));
+            _blocked++;
+            return MigrationOutcome::Blocked;
+        }
+    }
+
+    byte upgraded[PROFILE_BLOCK_SIZE];
+    encodeProfile(fields, upgraded); // the last step validated the fields
+    if (!session->writeBlockIfChanged(PROFILE_BLOCK, upgraded))
+    {
+        Serial.println("[CardMigrator] Write failed, retried on the next tap");
+        _failed++;
+        return MigrationOutcome::Failed;
+    }
+    memcpy(block, upgraded, PROFILE_BLOCK_SIZE);
+
+    _lastMs = millis() - start;
+    _maxMs = max(_maxMs, _lastMs);
+    countMigrated();
+    Serial.print("[CardMigrator] Card upgraded from ");
+    Serial.print(profileVersionName(fromVersion));
+    Serial.print(" in ");
+    Serial.print(_lastMs);
+    Serial.println(" ms");
+    return MigrationOutcome::Migrated;
+}
+
+String CardMigrator::statsJson() const
+{
+    uint32_t taps = 0;
+    for (uint8_t v = 0; v < PROFILE_VERSION_COUNT; v++)
+    {
+        taps += _seen[v];
+    }
+
+    String json = "{";
+    json += "\"currentVersion\":" + String(PROFILE_VERSION_CURRENT) + ",";
+    json += "\"seen\":{";
+    for (uint8_t v = 0; v < PROFILE_VERSION_COUNT; v++)
+    {
+        json += (v > 0 ? ",\"" : "\"") + String(profileVersionName(v)) + "\":" + String(_seen[v]);
+    }
+    json += "},";
+    // Share of taps that came in already current: how much of the fleet in play is done
+    json += "\"currentSharePct\":" + String(taps ? _seen[PROFILE_VERSION_CURRENT] * 100 / taps : 0) + ",";
+    json += "\"migrated\":" + String(_migrated) + ",";
+    json += "\"migratedTotal\":" + String(_migratedTotal) + ",";
+    json += "\"deferred\":" + String(_deferred) + ",";
+    json += "\"blocked\":" + String(_blocked) + ",";
+    json += "\"failed\":" + String(_failed) + ",";
+    json += "\"lastMs\":" + String(_lastMs) + ",";
+    json += "\"maxMs\":" + String(_maxMs) + "}";
+    return json;
+}
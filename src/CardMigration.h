@@ -0,0 +1,58 @@
+// CardMigration.h
+#ifndef CARDMIGRATION_H
+#define CARDMIGRATION_H
+
+#include <Arduino.h>
+#include "RFIDSession.h"
+#include "ProfileCodec.h"
+
+#define CARD_MIGRATION_BUDGET_MS 120 // Tap time after which no upgrade is started
+#define CARD_MIGRATION_WRITE_MS 20   // Worst-case profile block write, kept in reserve
+
+enum class MigrationOutcome : uint8_t
+{
+    Current,  // already at PROFILE_VERSION_CURRENT, or nothing to migrate
+    Migrated, // written back at the current version this tap
+    Deferred, // out of time budget, or the card has left the field
+    Blocked,  // an upgrade step cannot carry this card's data; it stays readable as is
+    Failed    // write failed, retried on the next tap
+};
+
+// Brings cards written in an older record layout up to the current one
+// while they are on the pad. ProfileCodec.cpp has a decoder per version and
+// CardMigration.cpp an upgrade step per version; a tap decodes at the card's
+// version, runs each step up to the current version and writes the block
+// back, as long as the tap is still inside CARD_MIGRATION_BUDGET_MS. Counts what it
+// sees per version so /stats shows how far the fleet has come.
+class CardMigrator
+{
+public:
+    CardMigrator();
+
+    void begin(); // load the lifetime migrated count from NVS
+
+    // block is the profile as read this tap, fromVersion its version before
+    // any other rewrite this tap (the coin move also writes the current
+    // version). session is nullptr when the card is no longer selected.
+    // The block is updated in place when it is written.
+    MigrationOutcome migrate(RFIDSession *session, byte *block, uint8_t fromVersion, unsigned long tapStart);
+
+    uint32_t migrated() const { return _migrated; }
+    String statsJson() const;
+
+private:
+    void countMigrated();
+
+    uint32_t _seen[PROFILE_VERSION_COUNT]; // taps per card version
+    uint32_t _migrated;
+    uint32_t _migratedTotal; // across reboots
+    uint32_t _deferred;
+    uint32_t _blocked;
+    uint32_t _failed;
+    uint32_t _lastMs;
+    uint32_t _maxMs;
+};
+
+extern CardMigrator cardMigrator;
+
+#endif // CARDMIGRATION_H
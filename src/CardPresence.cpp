@@ -0,0 +1,87 @@
+#include "CardPresence.h"
+#include "CardDetect.h"
+#include "GlobalDefs.h"
+
+CardPresence::CardPresence(MFRC522 &mfrc522)
+    : _mfrc522(mfrc522), _tracking(false), _present(false), _misses(0), _lastCheck(0),
+      _presentSince(0), _removedAt(0), _checks(0), _lastCheckUs(0)
+{
+    _uid.size = 0;
+}
+
+void CardPresence::track(const MFRC522::Uid &uid)
+{
+    _uid = uid;
+    _tracking = true;
+    _present = true;
+    _misses = 0;
+    _lastCheck = millis();
+    _presentSince = _lastCheck;
+}
+
+void CardPresence::forget()
+{
+    _tracking = false;
+    _present = false;
+    _misses = 0;
+}
+
+PresenceEvent CardPresence::poll()
+{
+    unsigned long now = millis();
+    if (!_tracking || now - _lastCheck < PRESENCE_CHECK_MS)
+    {
+        return PresenceEvent::None;
+    }
+    _lastCheck = now;
+
+    if (check())
+    {
+        _misses = 0;
+        if (!_present)
+        {
+            _present = true;
+            _presentSince = now;
+            return PresenceEvent::Present;
+        }
+        return PresenceEvent::None;
+    }
+
+    if (_present && ++_misses >= PRESENCE_MISS_LIMIT)
+    {
+        // Once off the reader the card comes back through a normal REQA tap
+        _present = false;
+        _tracking = false;
+        _removedAt = now;
+        return PresenceEvent::Removed;
+    }
+    return PresenceEvent::None;
+}
+
+// WUPA wakes the halted card, then a select with every UID bit known goes
+// straight to that card (no anticollision), then it is halted again
+bool CardPresence::check()
+{
+    uint32_t start = micros();
+    cardDetectDisarm(_mfrc522);
+
+    byte atqa[2];
+    byte atqaSize = sizeof(atqa);
+    MFRC522::StatusCode status = _mfrc522.PICC_WakeupA(atqa, &atqaSize);
+
+    // A collision still means cards answered; the select below picks ours out
+    bool found = false;
+    if (status == MFRC522::STATUS_OK || status == MFRC522::STATUS_COLLISION)
+    {
+        MFRC522::Uid uid = _uid;
+        found = _mfrc522.PICC_Select(&uid, uid.size * 8) == MFRC522::STATUS_OK;
+        if (found)
+        {
+            _mfrc522.PICC_HaltA();
+        }
+    }
+
+    _checks++;
+    _lastCheckUs = micros() - start;
+    return found;
+}
@@ -0,0 +1,53 @@
+// CardPresence.h
+#ifndef CARDPRESENCE_H
+#define CARDPRESENCE_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+
+enum class PresenceEvent : uint8_t
+{
+    None,
+    Present,
+    Removed
+};
+
+// Tracks whether the last tapped (and halted) card is still on the reader.
+// Each check is WUPA + a select of the known UID + HLTA: a few ms, with no
+// anticollision round, and the card is left halted so it is not seen as a
+// new tap. PRESENCE_MISS_LIMIT consecutive misses make a Removed event.
+class CardPresence
+{
+public:
+    explicit CardPresence(MFRC522 &mfrc522);
+
+    void track(const MFRC522::Uid &uid); // card just tapped, present from now
+    void forget();
+
+    // At most one check per PRESENCE_CHECK_MS; only call while no other
+    // card work is in progress
+    PresenceEvent poll();
+
+    bool tracking() const { return _tracking; }
+    bool isPresent() const { return _present; }
+    unsigned long presentSince() const { return _presentSince; }
+    unsigned long removedAt() const { return _removedAt; }
+    uint32_t checks() const { return _checks; }
+    uint32_t lastCheckUs() const { return _lastCheckUs; }
+
+private:
+    bool check();
+
+    MFRC522 &_mfrc522;
+    MFRC522::Uid _uid;
+    bool _tracking;
+    bool _present;
+    uint8_t _misses;
+    unsigned long _lastCheck;
+    unsigned long _presentSince;
+    unsigned long _removedAt;
+    uint32_t _checks;
+    uint32_t _lastCheckUs;
+};
+
+#endif // CARDPRESENCE_H
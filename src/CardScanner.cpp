@@ -0,0 +1,106 @@
+#include "CardScanner.h"
+
+#define SELECT_RETRIES 3 // Anticollision attempts before giving up on the field
+
+static CardScanStats stats = {0, 0, 0, 0, 0.0f};
+
+const CardScanStats &cardScanStats()
+{
+    return stats;
+}
+
+static bool sameUid(const MFRC522::Uid &a, const MFRC522::Uid &b)
+{
+    return a.size == b.size && memcmp(a.uidByte, b.uidByte, a.size) == 0;
+}
+
+static bool alreadyScanned(const TapBuffer *cards, uint8_t count, const MFRC522::Uid &uid)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (sameUid(cards[i].uid, uid))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read the selected card's tap blocks, then halt it so it drops out of
+// the next REQA round. A failed auth or read leaves the card in IDLE, where
+// it ignores HLTA and would answer every REQA after, so it is selected
+// again first. REQA rather than the session's WUPA: WUPA would also wake
+// every card already halted.
+static void readAndHalt(MFRC522 &mfrc522, RFIDSession &session, TapBuffer &card)
+{
+    session.newTap(); // different card, nothing in the shadow applies
+    if (!readAhead(mfrc522, session, card))
+    {
+        session.end();
+        byte atqa[2];
+        byte atqaSize = sizeof(atqa);
+        mfrc522.PICC_RequestA(atqa, &atqaSize);
+        mfrc522.PICC_Select(&mfrc522.uid, mfrc522.uid.size * 8);
+    }
+    mfrc522.PICC_HaltA();
+    session.end();
+}
+
+uint8_t scanAllCards(MFRC522 &mfrc522, RFIDSession &session, TapBuffer *cards, uint8_t maxCards)
+{
+    unsigned long start = millis();
+    uint8_t count = 0;
+
+    if (maxCards > 0)
+    {
+        readAndHalt(mfrc522, session, cards[count++]);
+    }
+
+    uint8_t failures = 0;
+    while (count < maxCards && failures < SELECT_RETRIES)
+    {
+        // Only cards still in IDLE answer REQA; the ones already read are HALTed
+        byte atqa[2];
+        byte atqaSize = sizeof(atqa);
+        MFRC522::StatusCode status = mfrc522.PICC_RequestA(atqa, &atqaSize);
+        if (status != MFRC522::STATUS_OK && status != MFRC522::STATUS_COLLISION)
+        {
+            break; // Nobody left in the field
+        }
+
+        // Resolve collisions bit by bit and select one card
+        mfrc522.uid.size = 0;
+        if (mfrc522.PICC_Select(&mfrc522.uid) != MFRC522::STATUS_OK)
+        {
+            failures++;
+            continue;
+        }
+
+        // A card that could not be halted answers again: halt it, never read it twice
+        if (alreadyScanned(cards, count, mfrc522.uid))
+        {
+            mfrc522.PICC_HaltA();
+            failures++;
+            continue;
+        }
+
+        readAndHalt(mfrc522, session, cards[count++]);
+        failures = 0;
+    }
+
+    stats.scans++;
+    stats.cards += count;
+    stats.lastCount = count;
+    stats.lastMs = millis() - start;
+    stats.lastCardsPerSec = stats.lastMs > 0 ? (count * 1000.0f) / stats.lastMs : 0.0f;
+
+    Serial.print("[scanAllCards] Cards: ");
+    Serial.print(count);
+    Serial.print(" in ");
+    Serial.print(stats.lastMs);
+    Serial.print(" ms (");
+    Serial.print(stats.lastCardsPerSec);
+    Serial.println(" cards/s)");
+
+    return count;
+}
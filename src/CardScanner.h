@@ -0,0 +1,30 @@
+// CardScanner.h
+#ifndef CARDSCANNER_H
+#define CARDSCANNER_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFIDSession.h"
+#include "TapBuffer.h"
+
+#define MAX_BATCH_CARDS 8 // Most cards enumerated in one group tap
+
+// Group tap: enumerate every card in the field with the ISO14443A
+// anticollision loop (PICC_Select walks the cascade levels), read each
+// card's tap blocks and HLTA the card so the next REQA only wakes the rest.
+// The card already selected in mfrc522.uid is read first.
+// Returns the number of cards written to cards[].
+uint8_t scanAllCards(MFRC522 &mfrc522, RFIDSession &session, TapBuffer *cards, uint8_t maxCards);
+
+// Stats for the last scan and totals
+struct CardScanStats
+{
+    uint32_t scans;
+    uint32_t cards;
+    uint8_t lastCount;
+    uint32_t lastMs;
+    float lastCardsPerSec;
+};
+const CardScanStats &cardScanStats();
+
+#endif // CARDSCANNER_H
@@ -0,0 +1,155 @@
+#include "CodecBench.h"
+#include "ProfileCodec.h"
+
+// Keeps the compiler from dropping calls whose results are unused
+static volatile uint8_t benchSink;
+
+static bool sameFields(const ProfileFields &a, const ProfileFields &b)
+{
+#define PROFILE_SAME(member, type, bits, max, jsonKey, jsonMask, formParam) \
+    if (a.member != b.member)                                             \
+    {                                                                     \
+        return false;                                                     \
+    }
+    PROFILE_FIELDS(PROFILE_SAME)
+#undef PROFILE_SAME
+    return strcmp(a.name, b.name) == 0;
+}
+
+static uint32_t timeDecode(const uint8_t *block, uint32_t iterations)
+{
+    ProfileFields fields;
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        benchSink = (uint8_t)decodeProfile(block, fields);
+    }
+    return (micros() - start) * 1000UL / iterations;
+}
+
+static void fuzz(CodecBenchResult &result, const uint8_t *valid, uint32_t blocks)
+{
+    uint8_t block[PROFILE_BLOCK_SIZE];
+    uint8_t encoded[PROFILE_BLOCK_SIZE];
+    ProfileFields fields, again;
+
+    for (uint32_t n = 0; n < blocks; n++)
+    {
+        for (uint8_t i = 0; i < PROFILE_BLOCK_SIZE; i += 4)
+        {
+            uint32_t r = esp_random();
+            memcpy(block + i, &r, 4);
+        }
+        // Half the blocks get a valid frame around random content, so the field
+        // and name decoding is exercised and not just the CRC/digit checks
+        if (n % 4 == 1)
+        {
+            block[0] = PROFILE_FORMAT_V1;
+            uint16_t crc = profileCrc16(block, PROFILE_BLOCK_SIZE - 2);
+            block[PROFILE_BLOCK_SIZE - 2] = crc >> 8;
+            block[PROFILE_BLOCK_SIZE - 1] = crc & 0xFF;
+        }
+        else if (n % 4 == 2)
+        {
+            for (uint8_t i = 0; i < PROFILE_DIGITS; i++)
+            {
+                block[i] = '0' + block[i] % 10;
+            }
+            block[PROFILE_DIGITS] = PROFILE_SEPARATOR;
+        }
+        result.fuzzBlocks++;
+
+        if (decodeProfile(block, fields) != ProfileError::Ok)
+        {
+            continue;
+        }
+        result.fuzzDecoded++;
+        sanitizeProfileName(fields.name); // legacy names may hold anything
+        if (validateProfile(fields) != ProfileError::Ok)
+        {
+            continue; // a legacy value the binary record cannot hold; such cards stay ASCII
+        }
+        if (encodeProfile(fields, encoded) != ProfileError::Ok ||
+            decodeProfile(encoded, again) != ProfileError::Ok || !sameFields(fields, again))
+        {
+            result.roundTripErrors++;
+        }
+    }
+
+    // CRC-16 must catch every single-bit error in a binary record, and none
+    // may pass for a blank card
+    for (uint8_t bit = 0; bit < PROFILE_BLOCK_SIZE * 8; bit++)
+    {
+        memcpy(block, valid, PROFILE_BLOCK_SIZE);
+        block[bit / 8] ^= 1 << (bit % 8);
+        result.bitFlips++;
+        ProfileError error = decodeProfile(block, fields);
+        if (error == ProfileError::Ok || error == ProfileError::Blank)
+        {
+            result.bitFlipsMissed++;
+        }
+    }
+}
+
+CodecBenchResult runCodecBench(uint32_t iterations, uint32_t fuzzBlocks)
+{
+    CodecBenchResult result;
+    memset(&result, 0, sizeof(result));
+    iterations = constrain(iterations, (uint32_t)1, (uint32_t)CODEC_BENCH_MAX_RUNS);
+    fuzzBlocks = min(fuzzBlocks, (uint32_t)CODEC_BENCH_MAX_RUNS);
+    result.iterations = iterations;
+
+    ProfileFields sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.age = 12;
+    sample.coins = 40;
+    sample.creatureType = 26;
+    sample.bools = 0x1F;
+    strcpy(sample.name, "Flamey");
+
+    uint8_t binary[PROFILE_BLOCK_SIZE];
+    encodeProfile(sample, binary);
+    const uint8_t ascii[PROFILE_BLOCK_SIZE] = {'1', '2', '4', '0', '2', '6', '1', '5', '%', 'F', 'l', 'a', 'm', 'e', 'y', 0};
+
+    uint32_t heapBefore = ESP.getFreeHeap();
+    result.decodeBinaryNs = timeDecode(binary, iterations);
+    result.decodeAsciiNs = timeDecode(ascii, iterations);
+
+    uint8_t out[PROFILE_BLOCK_SIZE];
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        benchSink = (uint8_t)encodeProfile(sample, out);
+    }
+    result.encodeNs = (micros() - start) * 1000UL / iterations;
+    result.heapDelta = (int32_t)heapBefore - (int32_t)ESP.getFreeHeap();
+
+    fuzz(result, binary, fuzzBlocks);
+
+    Serial.print("[runCodecBench] decode ");
+    Serial.print(result.decodeBinaryNs);
+    Serial.print(" ns (ascii ");
+    Serial.print(result.decodeAsciiNs);
+    Serial.print(" ns), encode ");
+    Serial.print(result.encodeNs);
+    Serial.print(" ns, fuzz errors ");
+    Serial.println(result.roundTripErrors + result.bitFlipsMissed);
+    return result;
+}
+
+String codecBenchJson(const CodecBenchResult &result)
+{
+    String json = "{";
+    json += "\"iterations\":" + String(result.iterations) + ",";
+    json += "\"decodeBinaryNs\":" + String(result.decodeBinaryNs) + ",";
+    json += "\"decodeAsciiNs\":" + String(result.decodeAsciiNs) + ",";
+    json += "\"encodeNs\":" + String(result.encodeNs) + ",";
+    json += "\"heapDelta\":" + String(result.heapDelta) + ",";
+    json += "\"fuzz\":{";
+    json += "\"blocks\":" + String(result.fuzzBlocks) + ",";
+    json += "\"decoded\":" + String(result.fuzzDecoded) + ",";
+    json += "\"roundTripErrors\":" + String(result.roundTripErrors) + ",";
+    json += "\"bitFlips\":" + String(result.bitFlips) + ",";
+    json += "\"bitFlipsMissed\":" + String(result.bitFlipsMissed) + "}}";
+    return json;
+}
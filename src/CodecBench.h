@@ -0,0 +1,34 @@
+// CodecBench.h
+#ifndef CODECBENCH_H
+#define CODECBENCH_H
+
+#include <Arduino.h>
+
+#define CODEC_BENCH_ITERATIONS 2000  // Calls timed per operation
+#define CODEC_BENCH_FUZZ_BLOCKS 5000 // Random blocks thrown at the decoder
+#define CODEC_BENCH_MAX_RUNS 20000   // Cap for ?n= so a request cannot stall the server
+
+struct CodecBenchResult
+{
+    uint32_t iterations;
+    uint32_t decodeBinaryNs; // per call
+    uint32_t decodeAsciiNs;
+    uint32_t encodeNs;
+    int32_t heapDelta; // free heap lost across all timed calls, should stay 0
+
+    uint32_t fuzzBlocks;
+    uint32_t fuzzDecoded;     // random blocks that decoded Ok
+    uint32_t roundTripErrors; // decoded Ok but re-encode/decode changed the fields
+    uint32_t bitFlips;        // single-bit corruptions of valid records
+    uint32_t bitFlipsMissed;  // ...that still decoded Ok or read as blank
+};
+
+// On-device cost and robustness check of the profile codec, for tracking
+// it across releases from /codecBench. Timing uses micros() over many calls.
+// The fuzz pass feeds random 16-byte blocks and single-bit corruptions of
+// valid records through decode/encode and counts any misbehaviour.
+CodecBenchResult runCodecBench(uint32_t iterations = CODEC_BENCH_ITERATIONS,
+                               uint32_t fuzzBlocks = CODEC_BENCH_FUZZ_BLOCKS);
+String codecBenchJson(const CodecBenchResult &result);
+
+#endif // CODECBENCH_H
@@ -0,0 +1,53 @@
+#include "CoinStore.h"
+#include "RFIDData.h"
+
+bool loadCoins(RFIDSession &session, byte *profileBlock, byte *coinBlock, int32_t &coins)
+{
+    ProfileFields parsed;
+    decodeProfile(profileBlock, parsed);
+
+    if (parsed.bools & COINS_IN_VALUE_BLOCK)
+    {
+        return decodeValueBlock(coinBlock, coins);
+    }
+
+    // Legacy card: move the coins into the value block, then flag the profile.
+    // The flagged profile is built first so a name or field the binary record
+    // cannot hold leaves the coins where they are.
+    ProfileFields migrated = parsed;
+    migrated.coins = 0;
+    migrated.bools = (parsed.bools & BOOLS_MASK) | COINS_IN_VALUE_BLOCK;
+    sanitizeProfileName(migrated.name);
+    byte migratedBlock[16];
+    if (encodeProfile(migrated, migratedBlock) != ProfileError::Ok)
+    {
+        Serial.println("[loadCoins] Profile cannot be migrated, coins stay in the profile");
+        return false;
+    }
+
+    Serial.print("[loadCoins] Migrating legacy coins: ");
+    Serial.println(parsed.coins);
+
+    coins = parsed.coins;
+    if (!session.writeValue(COIN_VALUE_BLOCK, coins))
+    {
+        return false;
+    }
+    encodeValueBlock(coins, COIN_VALUE_BLOCK, coinBlock);
+    memcpy(profileBlock, migratedBlock, sizeof(migratedBlock));
+
+    // If this write fails the next tap migrates again from the same digits
+    return session.writeBlockIfChanged(PROFILE_BLOCK, profileBlock);
+}
+
+bool awardCoins(RFIDSession &session, int32_t amount)
+{
+    if (!session.addValue(COIN_VALUE_BLOCK, amount))
+    {
+        Serial.println("[awardCoins] Card update failed");
+        return false;
+    }
+    Serial.print("[awardCoins] Added on card: ");
+    Serial.println(amount);
+    return true;
+}
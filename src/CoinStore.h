@@ -0,0 +1,25 @@
+// CoinStore.h
+#ifndef COINSTORE_H
+#define COINSTORE_H
+
+#include <Arduino.h>
+#include "RFIDSession.h"
+
+// Coins live in a MIFARE Classic value block next to the profile (same
+// sector, so no extra auth). The profile's bools field carries a flag bit
+// saying so, and its two coin digits are left at 00.
+#define COIN_VALUE_BLOCK 2
+#define COINS_IN_VALUE_BLOCK 0x10 // Flag in the profile bools field
+#define BOOLS_MASK 0x0F           // Challenge bits A-D
+
+// Return the balance from the read-ahead coin block, making sure the card
+// keeps its coins in the value block. Legacy cards (coins in the profile
+// digits) are migrated on the spot: the value block is created from the
+// profile coins and the profile is rewritten with the flag set. Both blocks
+// are updated to match the card. Only a migration touches the card.
+bool loadCoins(RFIDSession &session, byte *profileBlock, byte *coinBlock, int32_t &coins);
+
+// Single card-side increment (or decrement for negative amounts)
+bool awardCoins(RFIDSession &session, int32_t amount);
+
+#endif // COINSTORE_H
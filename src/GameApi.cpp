@@ -0,0 +1,409 @@
+#include "GameApi.h"
+
+GameApiClient gameApi;
+JsonBudget apiJsonBudget;
+
+// Each block carries its size so deallocate() can return it to the budget
+union BudgetHeader
+{
+    size_t size;
+    max_align_t align; // keep the caller's memory aligned as malloc() would
+};
+
+JsonBudget::JsonBudget() : _lock(portMUX_INITIALIZER_UNLOCKED), _used(0), _peak(0), _refused(0)
+{
+}
+
+// Move the budget from oldSize to newSize bytes for one block, if it fits
+bool JsonBudget::reserve(size_t oldSize, size_t newSize)
+{
+    bool fits;
+    portENTER_CRITICAL(&_lock);
+    fits = _used - oldSize + newSize <= GAME_API_JSON_BYTES;
+    if (fits)
+    {
+        _used = _used - oldSize + newSize;
+        _peak = max(_peak, _used);
+    }
+    else
+    {
+        _refused++;
+    }
+    portEXIT_CRITICAL(&_lock);
+    return fits;
+}
+
+void *JsonBudget::allocate(size_t size)
+{
+    if (!reserve(0, size))
+    {
+        return nullptr;
+    }
+    BudgetHeader *header = (BudgetHeader *)malloc(sizeof(BudgetHeader) + size);
+    if (header == nullptr)
+    {
+        reserve(size, 0);
+        return nullptr;
+    }
+    header->size = size;
+    return header + 1;
+}
+
+void JsonBudget::deallocate(void *ptr)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    BudgetHeader *header = (BudgetHeader *)ptr - 1;
+    reserve(header->size, 0);
+    free(header);
+}
+
+void *JsonBudget::reallocate(void *ptr, size_t size)
+{
+    if (ptr == nullptr)
+    {
+        return allocate(size);
+    }
+    BudgetHeader *header = (BudgetHeader *)ptr - 1;
+    size_t old = header->size;
+    if (!reserve(old, size))
+    {
+        return nullptr;
+    }
+    BudgetHeader *moved = (BudgetHeader *)realloc(header, sizeof(BudgetHeader) + size);
+    if (moved == nullptr)
+    {
+        reserve(size, old); // the old block is still there
+        return nullptr;
+    }
+    moved->size = size;
+    return moved + 1;
+}
+
+// Next non-whitespace character, or -1 once the stream times out
+static int nextToken(Stream &body)
+{
+    char c;
+    while (body.readBytes(&c, 1) == 1)
+    {
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+        {
+            return c;
+        }
+    }
+    return -1;
+}
+
+bool readJsonArray(Stream &body, bool (*onElement)(JsonVariantConst element, void *context), void *context)
+{
+    if (nextToken(body) != '[')
+    {
+        return false;
+    }
+    if (body.peek() == ']')
+    {
+        body.read();
+        return true; // empty array
+    }
+
+    JsonDocument element(&apiJsonBudget);
+    while (true)
+    {
+        // deserializeJson() stops at the end of the element, leaving the separator
+        DeserializationError error = deserializeJson(element, body);
+        if (error)
+        {
+            Serial.println("[readJsonArray] " + String(error.c_str()));
+            return false;
+        }
+        if (!onElement(element.as<JsonVariantConst>(), context))
+        {
+            return false;
+        }
+        int separator = nextToken(body);
+        if (separator == ']')
+        {
+            return true;
+        }
+        if (separator != ',')
+        {
+            return false; // malformed, or the body stalled
+        }
+    }
+}
+
+// Log the message or error an API call sends back; the rest of the body is
+// filtered out as it streams past. context is the caller's log prefix.
+bool logApiReply(Stream &body, void *context)
+{
+    JsonDocument filter;
+    filter["message"] = true;
+    filter["error"] = true;
+
+    JsonDocument reply(&apiJsonBudget);
+    DeserializationError error = deserializeJson(reply, body, DeserializationOption::Filter(filter));
+    Serial.print((const char *)context);
+    if (error)
+    {
+        Serial.println(" Unreadable response: " + String(error.c_str()));
+        return false;
+    }
+    Serial.print(" Response: ");
+    serializeJson(reply, Serial);
+    Serial.println();
+    return true;
+}
+
+GameApiClient::Connection::Connection()
+    : client(), http(client, GAME_API_HOST, GAME_API_PORT), lastUsed(0), requests(0)
+{
+    http.connectionKeepAlive();
+}
+
+GameApiClient::GameApiClient()
+    : _resolvedAt(0), _resolved(false), _requests(0), _connects(0), _reused(0), _retries(0), _failures(0),
+      _parseFailures(0), _bodyBytes(0), _maxBodyBytes(0), _dnsLookups(0), _dnsHits(0), _totalMs(0), _maxMs(0)
+{
+}
+
+bool GameApiClient::resolve(IPAddress &address)
+{
+    if (_resolved && millis() - _resolvedAt < GAME_API_DNS_TTL_MS)
+    {
+        _dnsHits++;
+        address = _address;
+        return true;
+    }
+    _dnsLookups++;
+    if (WiFi.hostByName(GAME_API_HOST, _address) != 1)
+    {
+        Serial.println("[GameApi] DNS lookup failed");
+        _resolved = false;
+        return false;
+    }
+    _resolved = true;
+    _resolvedAt = millis();
+    address = _address;
+    return true;
+}
+
+void GameApiClient::close(Connection &conn)
+{
+    conn.http.stop();
+    conn.requests = 0;
+}
+
+void GameApiClient::closeIdle()
+{
+    for (Connection &conn : _pool)
+    {
+        if (conn.requests > 0 && millis() - conn.lastUsed > GAME_API_IDLE_MS)
+        {
+            close(conn);
+        }
+    }
+}
+
+void GameApiClient::closeAll()
+{
+    for (Connection &conn : _pool)
+    {
+        close(conn);
+    }
+}
+
+// A live connection if there is one, else the least recently used slot reopened
+GameApiClient::Connection *GameApiClient::acquire()
+{
+    closeIdle();
+
+    Connection *oldest = &_pool[0];
+    for (Connection &conn : _pool)
+    {
+        if (conn.requests > 0 && conn.client.connected())
+        {
+            _reused++;
+            return &conn;
+        }
+        if (conn.lastUsed < oldest->lastUsed)
+        {
+            oldest = &conn;
+        }
+    }
+
+    close(*oldest); // a server-closed socket still needs its state reset
+    IPAddress address;
+    if (!resolve(address))
+    {
+        return nullptr;
+    }
+    _connects++;
+    if (!oldest->client.connect(address, GAME_API_PORT))
+    {
+        Serial.println("[GameApi] Connect failed");
+        _resolved = false; // the address may have moved
+        return nullptr;
+    }
+    oldest->client.setNoDelay(true);
+    return oldest;
+}
+
+int GameApiClient::exchange(Connection &conn, bool post, const char *path, const String &payload, GameApiReader reader,
+                            void *context, const char *idempotencyKey)
+{
+    int err;
+    if (post && idempotencyKey != nullptr)
+    {
+        conn.http.beginRequest();
+        err = conn.http.post(path);
+        if (err == HTTP_SUCCESS)
+        {
+            conn.http.sendHeader("Content-Type", "application/json");
+            conn.http.sendHeader("Content-Length", (int)payload.length());
+            conn.http.sendHeader("Idempotency-Key", idempotencyKey);
+            conn.http.beginBody();
+            conn.http.print(payload);
+            conn.http.endRequest();
+        }
+    }
+    else
+    {
+        err = post ? conn.http.post(path, "application/json", payload.c_str()) : conn.http.get(path);
+    }
+    if (err != HTTP_SUCCESS)
+    {
+        return err;
+    }
+    conn.http.setHttpResponseTimeout(GAME_API_TIMEOUT_MS); // startRequest() put back the 30 s default
+
+    int status = conn.http.responseStatusCode();
+    if (status < 0)
+    {
+        return status;
+    }
+
+    bool serverCloses = false;
+    while (conn.http.headerAvailable())
+    {
+        String name = conn.http.readHeaderName();
+        if (name.equalsIgnoreCase("Connection"))
+        {
+            serverCloses = conn.http.readHeaderValue().equalsIgnoreCase("close");
+        }
+    }
+
+    // Without a Content-Length the body only ends when the server closes,
+    // so such a connection cannot be reused
+    int length = conn.http.contentLength();
+    bool delimited = length >= 0;
+    if (delimited)
+    {
+        _bodyBytes += length;
+        _maxBodyBytes = max(_maxBodyBytes, (uint32_t)length);
+    }
+
+    // The body is parsed as it arrives; whatever the reader leaves (a
+    // trailing newline, or all of it without a reader) is skipped
+    conn.http.setTimeout(GAME_API_TIMEOUT_MS);
+    bool parsed = reader == nullptr || status / 100 != 2 || reader(conn.http, context);
+    if (!parsed)
+    {
+        _parseFailures++;
+        Serial.println("[GameApi] Could not parse the response to " + String(path));
+    }
+    char skipped; // a byte at a time, so nothing waits on bytes past the body
+    while (parsed && delimited && !conn.http.endOfBodyReached() && conn.http.readBytes(&skipped, 1) == 1)
+    {
+    }
+
+    conn.requests++;
+    conn.lastUsed = millis();
+    if (serverCloses || !delimited || !parsed || !conn.http.endOfBodyReached())
+    {
+        close(conn);
+    }
+    return status;
+}
+
+int GameApiClient::request(bool post, const char *path, const String &payload, GameApiReader reader, void *context,
+                           const char *idempotencyKey)
+{
+    if (WiFi.status() != WL_CONNECTED)
+    {
+        closeAll();
+        return HTTP_ERROR_CONNECTION_FAILED;
+    }
+
+    unsigned long start = millis();
+    _requests++;
+    int status = HTTP_ERROR_CONNECTION_FAILED;
+    for (uint8_t attempt = 0; attempt < 2; attempt++)
+    {
+        Connection *conn = acquire();
+        if (conn == nullptr)
+        {
+            break;
+        }
+        bool reused = conn->requests > 0;
+        status = exchange(*conn, post, path, payload, reader, context, idempotencyKey);
+        if (status >= 0)
+        {
+            break;
+        }
+        close(*conn);
+
+        // A kept-alive socket the server already dropped; only safe to repeat
+        // a request the server can recognise as a repeat
+        if (!reused || (post && idempotencyKey == nullptr))
+        {
+            break;
+        }
+        _retries++;
+    }
+
+    uint32_t ms = millis() - start;
+    _totalMs += ms;
+    _maxMs = max(_maxMs, ms);
+    if (status < 0)
+    {
+        _failures++;
+        Serial.print("[GameApi] ");
+        Serial.print(path);
+        Serial.print(" failed: ");
+        Serial.println(status);
+    }
+    return status;
+}
+
+int GameApiClient::get(const char *path, GameApiReader reader, void *context)
+{
+    return request(false, path, String(), reader, context, nullptr);
+}
+
+int GameApiClient::postJson(const char *path, const String &payload, GameApiReader reader, void *context,
+                            const char *idempotencyKey)
+{
+    return request(true, path, payload, reader, context, idempotencyKey);
+}
+
+String GameApiClient::statsJson() const
+{
+    String json = "{";
+    json += "\"requests\":" + String(_requests) + ",";
+    json += "\"connects\":" + String(_connects) + ",";
+    json += "\"reused\":" + String(_reused) + ",";
+    json += "\"retries\":" + String(_retries) + ",";
+    json += "\"failures\":" + String(_failures) + ",";
+    json += "\"parseFailures\":" + String(_parseFailures) + ",";
+    json += "\"bodyBytes\":" + String(_bodyBytes) + ",";
+    json += "\"maxBodyBytes\":" + String(_maxBodyBytes) + ",";
+    json += "\"jsonPeakBytes\":" + String(apiJsonBudget.peak()) + ",";
+    json += "\"jsonRefused\":" + String(apiJsonBudget.refused()) + ",";
+    json += "\"dnsLookups\":" + String(_dnsLookups) + ",";
+    json += "\"dnsHits\":" + String(_dnsHits) + ",";
+    json += "\"avgMs\":" + String(_requests ? _totalMs / _requests : 0) + ",";
+    json += "\"maxMs\":" + String(_maxMs) + "}";
+    return json;
+}
@@ -0,0 +1,128 @@
+// GameApi.h
+#ifndef GAMEAPI_H
+#define GAMEAPI_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ArduinoHttpClient.h>
+#include <ArduinoJson.h>
+
+#define GAME_API_HOST "gameapi-2e9bb6e38339.herokuapp.com"
+#define GAME_API_PORT 80
+#define GAME_API_POOL_SIZE 2          // Warm connections kept open
+#define GAME_API_IDLE_MS 30000UL      // Close a connection unused this long (server drops it at ~55 s)
+#define GAME_API_DNS_TTL_MS 300000UL  // Re-resolve the host after this
+#define GAME_API_TIMEOUT_MS 5000      // Response timeout per request, and per byte of the body
+#define GAME_API_JSON_BYTES 2048      // Heap one parsed response may use
+
+// Parses a response body straight off the socket. Returns false if the body
+// could not be read; the request still returns the HTTP status.
+typedef bool (*GameApiReader)(Stream &body, void *context);
+
+// Heap for parsed API responses, capped at GAME_API_JSON_BYTES in total
+// however large the response is. Give it to each JsonDocument that reads a
+// response; a document that outgrows it fails with NoMemory instead of
+// exhausting the heap. The network worker and the web server task (for
+// /apiBench) both draw on it, so the accounting is done under a lock.
+class JsonBudget : public ArduinoJson::Allocator
+{
+public:
+    JsonBudget();
+
+    void *allocate(size_t size) override;
+    void deallocate(void *ptr) override;
+    void *reallocate(void *ptr, size_t size) override;
+
+    size_t used() const { return _used; }
+    size_t peak() const { return _peak; }
+    uint32_t refused() const { return _refused; }
+    void resetPeak() { _peak = _used; }
+
+private:
+    bool reserve(size_t oldSize, size_t newSize);
+
+    portMUX_TYPE _lock;
+    size_t _used;
+    size_t _peak;
+    uint32_t _refused;
+};
+
+extern JsonBudget apiJsonBudget;
+
+// Reader that logs the "message" or "error" of a reply and filters out the
+// rest of the body; context is the caller's log prefix
+bool logApiReply(Stream &body, void *context);
+
+// Parse a top-level JSON array one element at a time, so only one element
+// is ever held in memory. onElement returns false to stop with a failure.
+// Bare numbers are not supported as elements: ArduinoJson reads one byte
+// past a number, which swallows the separator.
+bool readJsonArray(Stream &body, bool (*onElement)(JsonVariantConst element, void *context), void *context);
+
+// Client for the game API that keeps HTTP/1.1 connections alive between
+// requests, so a tap's lookup, create and coin calls share one warm socket
+// instead of a DNS lookup plus TCP handshake each. The host is resolved once
+// per GAME_API_DNS_TTL_MS and connections are opened to the cached address.
+// A connection found dead before a request is reopened transparently; a GET
+// that fails on a reused connection is retried once on a fresh one. So is a
+// POST that carries an Idempotency-Key; others are not, since the server may
+// already have applied them.
+// Bodies are never buffered: a reader parses them off the socket, and the
+// rest is skipped so the connection stays usable.
+class GameApiClient
+{
+public:
+    GameApiClient();
+
+    // HTTP status, or a negative HTTP_ERROR_* code. reader, if any, parses
+    // the body of a 2xx response; other bodies are skipped.
+    int get(const char *path, GameApiReader reader = nullptr, void *context = nullptr);
+    int postJson(const char *path, const String &payload, GameApiReader reader = nullptr, void *context = nullptr,
+                 const char *idempotencyKey = nullptr);
+
+    void closeIdle(); // drop connections unused for GAME_API_IDLE_MS
+    void closeAll();  // e.g. after WiFi dropped
+
+    uint32_t connects() const { return _connects; }
+    String statsJson() const;
+
+private:
+    struct Connection
+    {
+        Connection();
+        WiFiClient client; // declared before http, which keeps a reference to it
+        HttpClient http;
+        unsigned long lastUsed;
+        uint32_t requests; // on the current socket
+    };
+
+    int request(bool post, const char *path, const String &payload, GameApiReader reader, void *context,
+                const char *idempotencyKey);
+    int exchange(Connection &conn, bool post, const char *path, const String &payload, GameApiReader reader,
+                 void *context, const char *idempotencyKey);
+    Connection *acquire();
+    bool resolve(IPAddress &address);
+    void close(Connection &conn);
+
+    Connection _pool[GAME_API_POOL_SIZE];
+    IPAddress _address;
+    unsigned long _resolvedAt;
+    bool _resolved;
+
+    uint32_t _requests;
+    uint32_t _connects;
+    uint32_t _reused;
+    uint32_t _retries;
+    uint32_t _failures;
+    uint32_t _parseFailures;
+    uint32_t _bodyBytes;   // read off the socket, parsed or skipped
+    uint32_t _maxBodyBytes;
+    uint32_t _dnsLookups;
+    uint32_t _dnsHits;
+    uint32_t _totalMs;
+    uint32_t _maxMs;
+};
+
+extern GameApiClient gameApi;
+
+#endif // GAMEAPI_H
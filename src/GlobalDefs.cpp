@@ -1,8 +1,9 @@
 #include "GlobalDefs.h"
+#include "ReaderPool.h"
 
-MFRC522 mfrc522(SS_PIN, RST_PIN);
+MFRC522 &mfrc522 = readers[0].mfrc522;
 MFRC522::MIFARE_Key key;
-RFIDData pendingData;
+ProfileFields pendingData;
 bool dataPending = false;
 bool formSubmitted = false;
 bool allChallBools = false;
@@ -12,10 +12,34 @@
 #define SCK_PIN 25  // SPI Clock
 #define MISO_PIN 33 // Master In Slave Out
 #define MOSI_PIN 26 // Master Out Slave In
+#define IRQ_PIN -1  // MFRC522 IRQ, -1 if not wired (poll for cards instead)
 
-extern MFRC522 mfrc522;
+// Reader pads sharing the SPI bus and RST line, one SS pin each (SS_PIN is
+// reader 0). The card IRQ is only used with a single reader.
+#ifndef READER_COUNT
+#define READER_COUNT 1
+#endif
+#ifndef READER_SS_PINS
+#define READER_SS_PINS {SS_PIN} // e.g. {SS_PIN, 15, 2} for three pads
+#endif
+
+// Card detection timing
+#define CARD_POLL_INTERVAL_MS 200 // Delay between PICC_IsNewCardPresent() polls
+#define CARD_IRQ_REARM_MS 50      // How often REQA is re-sent while waiting on the IRQ
+
+// RFIDTransaction timeouts
+#define RFID_STEP_TIMEOUT_MS 250    // Max time an auth/read/write step may spend retrying
+#define RFID_CARD_WAIT_TIMEOUT_MS 0 // Max wait for a card, 0 = wait forever
+
+// Presence tracking of the last tapped card (removal shows within ~100 ms)
+#define PRESENCE_CHECK_MS 40  // Interval between WUPA + select checks
+#define PRESENCE_MISS_LIMIT 2 // Consecutive misses before the card counts as removed
+
+#define BATCH_SCAN_MODE 0 // 1 = read every card in the field per tap (group taps)
+
+extern MFRC522 &mfrc522; // reader 0
 extern MFRC522::MIFARE_Key key;
-extern RFIDData pendingData;
+extern ProfileFields pendingData;
 extern bool dataPending;
 extern TFT_eSPI tft;
 extern bool formSubmitted;
@@ -0,0 +1,288 @@
+#include "NameIndex.h"
+#include "GameApi.h"
+#include <SPIFFS.h>
+#include <WiFi.h>
+
+NameIndex nameIndex;
+
+static const byte indexMagic[4] = {'N', 'I', 'D', 'X'};
+
+static int compareHashes(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+NameIndex::NameIndex()
+    : _count(0), _ready(false), _dirty(false), _refreshing(false), _lastSyncOk(false), _syncedAt(0), _recentNext(0),
+      _lookups(0), _hits(0), _lookupUs(0), _maxLookupUs(0), _syncs(0), _syncFailures(0), _lastSyncMs(0), _dropped(0)
+{
+    memset(_recent, 0, sizeof(_recent));
+}
+
+uint32_t NameIndex::hash(const char *name, size_t length)
+{
+    uint32_t h = 2166136261UL; // FNV-1a
+    for (size_t i = 0; i < length; i++)
+    {
+        h ^= (uint8_t)name[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+void NameIndex::begin()
+{
+    _ready = load();
+    Serial.println("[NameIndex] " + String(_ready ? "Loaded " + String(_count) + " names" : "No saved index"));
+}
+
+bool NameIndex::contains(const char *name)
+{
+    unsigned long start = micros();
+    uint32_t key = hash(name, strlen(name));
+    bool found = bsearch(&key, _hashes, _count, sizeof(uint32_t), compareHashes) != nullptr;
+
+    uint32_t us = micros() - start;
+    _lookups++;
+    _lookupUs += us;
+    _maxLookupUs = max(_maxLookupUs, us);
+    if (found)
+    {
+        _hits++;
+    }
+    return found;
+}
+
+void NameIndex::add(const char *name)
+{
+    uint32_t key = hash(name, strlen(name));
+    _recent[_recentNext] = key;
+    _recentNext = (_recentNext + 1) % NAME_INDEX_RECENT;
+    if (insert(key))
+    {
+        _dirty = true; // flash write waits for poll(), off the tap path
+    }
+}
+
+bool NameIndex::insert(uint32_t key)
+{
+    // Lower bound: first entry not below key
+    uint16_t low = 0, high = _count;
+    while (low < high)
+    {
+        uint16_t mid = (low + high) / 2;
+        if (_hashes[mid] < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    if (low < _count && _hashes[low] == key)
+    {
+        return false;
+    }
+    if (_count == NAME_INDEX_CAPACITY)
+    {
+        _dropped++;
+        return false;
+    }
+    memmove(_hashes + low + 1, _hashes + low, (_count - low) * sizeof(uint32_t));
+    _hashes[low] = key;
+    _count++;
+    return true;
+}
+
+// Staging list a refresh builds on the network worker
+struct NameFetch
+{
+    uint32_t *names;
+    uint16_t count;
+    uint32_t dropped;
+};
+
+bool NameIndex::readName(JsonVariantConst element, void *context)
+{
+    NameFetch *fetch = (NameFetch *)context;
+    const char *name = element.as<const char *>();
+    if (name == nullptr)
+    {
+        return true; // not a name; skip it
+    }
+    if (fetch->count < NAME_INDEX_CAPACITY)
+    {
+        fetch->names[fetch->count++] = hash(name, strlen(name));
+    }
+    else
+    {
+        fetch->dropped++;
+    }
+    return true;
+}
+
+bool NameIndex::readNames(Stream &body, void *context)
+{
+    NameFetch *fetch = (NameFetch *)context;
+    if (!readJsonArray(body, readName, context))
+    {
+        free(fetch->names); // a partial list must not replace the index
+        fetch->names = nullptr;
+        return false;
+    }
+    return true;
+}
+
+int NameIndex::fetch(NetResult &result)
+{
+    NameFetch fetch = {(uint32_t *)malloc(NAME_INDEX_CAPACITY * sizeof(uint32_t)), 0, 0};
+    if (fetch.names == nullptr)
+    {
+        Serial.println("[NameIndex] No memory for a refresh");
+        return HTTP_ERROR_CONNECTION_FAILED;
+    }
+
+    int statusCode = gameApi.get(NAME_INDEX_API_PATH, readNames, &fetch);
+    if (statusCode != 200 && fetch.names != nullptr)
+    {
+        free(fetch.names);
+        fetch.names = nullptr;
+    }
+    if (fetch.names == nullptr)
+    {
+        return statusCode;
+    }
+
+    qsort(fetch.names, fetch.count, sizeof(uint32_t), compareHashes);
+    uint16_t unique = 0;
+    for (uint16_t i = 0; i < fetch.count; i++)
+    {
+        if (unique == 0 || fetch.names[i] != fetch.names[unique - 1])
+        {
+            fetch.names[unique++] = fetch.names[i];
+        }
+    }
+    result.names = fetch.names;
+    result.nameCount = unique;
+    result.namesDropped = fetch.dropped;
+    return statusCode;
+}
+
+void NameIndex::apply(NetResult &result)
+{
+    _refreshing = false;
+    _syncedAt = millis();
+    _lastSyncOk = result.names != nullptr;
+    if (!_lastSyncOk)
+    {
+        _syncFailures++;
+        Serial.println("[NameIndex] Refresh failed: " + String(result.status));
+        return;
+    }
+
+    memcpy(_hashes, result.names, result.nameCount * sizeof(uint32_t));
+    _count = result.nameCount;
+    _dropped = result.namesDropped;
+    free(result.names);
+    result.names = nullptr;
+    for (uint32_t key : _recent)
+    {
+        if (key != 0)
+        {
+            insert(key);
+        }
+    }
+    _ready = true;
+    _dirty = true;
+    _syncs++;
+    _lastSyncMs = result.waitMs + result.serviceMs;
+
+    Serial.println("[NameIndex] Refreshed " + String(_count) + " names in " + String(_lastSyncMs) + " ms");
+}
+
+void NameIndex::poll(bool idle)
+{
+    unsigned long interval = _lastSyncOk ? NAME_INDEX_SYNC_MS : NAME_INDEX_RETRY_MS;
+    bool attempted = _syncs + _syncFailures > 0;
+    if (!_refreshing && WiFi.status() == WL_CONNECTED && (!attempted || millis() - _syncedAt >= interval))
+    {
+        NetRequest request;
+        memset(&request, 0, sizeof(request));
+        request.kind = NetRequestKind::RefreshNames;
+        request.path = NAME_INDEX_API_PATH;
+        _refreshing = netWorker.submit(request);
+    }
+    if (idle && _dirty && save())
+    {
+        _dirty = false;
+    }
+}
+
+bool NameIndex::load()
+{
+    File file = SPIFFS.open(NAME_INDEX_PATH, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    byte header[8];
+    uint16_t count = 0;
+    bool ok = file.read(header, sizeof(header)) == sizeof(header) &&
+              memcmp(header, indexMagic, 4) == 0 &&
+              header[4] == NAME_INDEX_VERSION;
+    if (ok)
+    {
+        count = header[6] | (header[7] << 8);
+        ok = count <= NAME_INDEX_CAPACITY &&
+             file.read((uint8_t *)_hashes, count * sizeof(uint32_t)) == count * sizeof(uint32_t);
+    }
+    file.close();
+
+    // A torn or foreign file is ignored; the next refresh rebuilds it
+    _count = ok ? count : 0;
+    return ok;
+}
+
+bool NameIndex::save()
+{
+    File file = SPIFFS.open(NAME_INDEX_PATH, FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("[NameIndex] Could not open " NAME_INDEX_PATH);
+        return false;
+    }
+
+    byte header[8];
+    memcpy(header, indexMagic, 4);
+    header[4] = NAME_INDEX_VERSION;
+    header[5] = 0; // Reserved
+    header[6] = _count & 0xFF;
+    header[7] = _count >> 8;
+    bool ok = file.write(header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)_hashes, _count * sizeof(uint32_t)) == _count * sizeof(uint32_t);
+    file.close();
+    return ok;
+}
+
+String NameIndex::statsJson() const
+{
+    String json = "{";
+    json += "\"ready\":" + String(_ready ? "true" : "false") + ",";
+    json += "\"names\":" + String(_count) + ",";
+    json += "\"capacity\":" + String(NAME_INDEX_CAPACITY) + ",";
+    json += "\"dropped\":" + String(_dropped) + ",";
+    json += "\"lookups\":" + String(_lookups) + ",";
+    json += "\"hits\":" + String(_hits) + ",";
+    json += "\"avgLookupUs\":" + String(_lookups ? _lookupUs / _lookups : 0) + ",";
+    json += "\"maxLookupUs\":" + String(_maxLookupUs) + ",";
+    json += "\"syncs\":" + String(_syncs) + ",";
+    json += "\"syncFailures\":" + String(_syncFailures) + ",";
+    json += "\"lastSyncMs\":" + String(_lastSyncMs) + ",";
+    json += "\"syncAgeS\":" + String(_syncs + _syncFailures ? (millis() - _syncedAt) / 1000 : 0);
+    json += "}";
+    return json;
+}
@@ -0,0 +1,88 @@
+// NameIndex.h
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "NetWorker.h"
+
+#define NAME_INDEX_CAPACITY 2048          // Names held; 4 bytes each in RAM and flash
+#define NAME_INDEX_PATH "/names.idx"
+#define NAME_INDEX_VERSION 1
+#define NAME_INDEX_SYNC_MS 600000UL       // Refresh from the server this often
+#define NAME_INDEX_RETRY_MS 60000UL       // ...or this soon after a failed refresh
+#define NAME_INDEX_API_PATH "/api/v1/get_custom_names"
+#define NAME_INDEX_RECENT 32              // Local additions put back after a refresh
+
+// Which creature names the game server already has, kept on the unit so a
+// tap answers "is this creature new?" with a binary search instead of
+// downloading the whole name list. Holds a sorted array of 32-bit FNV-1a
+// hashes of the names, mirrored to SPIFFS so it is usable straight after a
+// reboot. Names this unit creates are added as soon as they are queued for
+// the server. The full list is refreshed in the background: the network
+// worker streams it one name at a time into a separate hash array, so the
+// list is never held as text, and loop() swaps it in. A hit can be a hash
+// collision with another name; at NAME_INDEX_CAPACITY names that is about
+// one lookup in two million.
+class NameIndex
+{
+public:
+    NameIndex();
+
+    void begin(); // load the flash copy, if any
+
+    // True once the index holds a server list (from flash or a refresh)
+    bool ready() const { return _ready; }
+
+    bool contains(const char *name);
+    void add(const char *name); // queued for creation on the server
+
+    // Upkeep from loop(): ask the network worker for a refresh when one is
+    // due, and write additions to flash once idle (no card on a pad)
+    void poll(bool idle);
+
+    // A RefreshNames result from the network worker, on loop()
+    void apply(NetResult &result);
+
+    // Network worker side of a refresh: download, hash, sort. Returns the
+    // HTTP status; result.names is left nullptr unless the whole list came in.
+    static int fetch(NetResult &result);
+
+    uint16_t size() const { return _count; }
+    String statsJson() const;
+
+    static uint32_t hash(const char *name, size_t length);
+
+private:
+    static bool readNames(Stream &body, void *context);
+    static bool readName(JsonVariantConst element, void *context);
+    bool insert(uint32_t hash);
+    bool load();
+    bool save();
+
+    uint32_t _hashes[NAME_INDEX_CAPACITY];
+    uint16_t _count;
+    bool _ready;
+    bool _dirty;      // additions not yet in flash
+    bool _refreshing; // a refresh is with the network worker
+    bool _lastSyncOk;
+    unsigned long _syncedAt;
+
+    // Names added here lately. A refresh that started before the server had
+    // them would drop them, so they are put back after each one.
+    uint32_t _recent[NAME_INDEX_RECENT];
+    uint8_t _recentNext;
+
+    uint32_t _lookups;
+    uint32_t _hits;
+    uint32_t _lookupUs;
+    uint32_t _maxLookupUs;
+    uint32_t _syncs;
+    uint32_t _syncFailures;
+    uint32_t _lastSyncMs;
+    uint32_t _dropped; // names past NAME_INDEX_CAPACITY
+};
+
+extern NameIndex nameIndex;
+
+#endif // NAMEINDEX_H
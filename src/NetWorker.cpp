@@ -0,0 +1,106 @@
+#include "NetWorker.h"
+#include "GameApi.h"
+#include "NameIndex.h"
+
+NetWorker netWorker;
+
+NetWorker::NetWorker()
+    : _requests(nullptr), _results(nullptr), _task(nullptr), _busy(false), _submitted(0), _queueFull(0), _completed(0),
+      _maxDepth(0), _totalWaitMs(0), _maxWaitMs(0), _totalServiceMs(0), _maxServiceMs(0)
+{
+}
+
+void NetWorker::begin()
+{
+    _requests = xQueueCreate(NET_QUEUE_DEPTH, sizeof(NetRequest));
+    _results = xQueueCreate(NET_QUEUE_DEPTH, sizeof(NetResult));
+    xTaskCreatePinnedToCore(taskMain, "netWorker", NET_WORKER_STACK, this, NET_WORKER_PRIORITY, &_task,
+                            NET_WORKER_CORE);
+    Serial.println("[NetWorker] Started on core " + String(NET_WORKER_CORE));
+}
+
+bool NetWorker::submit(NetRequest &request)
+{
+    request.queuedAt = millis();
+    if (xQueueSend(_requests, &request, 0) != pdTRUE)
+    {
+        _queueFull++;
+        return false;
+    }
+    _submitted++;
+    _maxDepth = max(_maxDepth, (uint32_t)uxQueueMessagesWaiting(_requests));
+    return true;
+}
+
+bool NetWorker::poll(NetResult &result)
+{
+    return xQueueReceive(_results, &result, 0) == pdTRUE;
+}
+
+void NetWorker::taskMain(void *arg)
+{
+    ((NetWorker *)arg)->run();
+}
+
+void NetWorker::run()
+{
+    NetRequest request;
+    NetResult result;
+    while (true)
+    {
+        if (xQueueReceive(_requests, &request, pdMS_TO_TICKS(NET_WORKER_IDLE_MS)) != pdTRUE)
+        {
+            gameApi.closeIdle(); // nothing to do: let sockets the server will drop go first
+            continue;
+        }
+
+        _busy = true;
+        unsigned long start = millis();
+        memset(&result, 0, sizeof(result));
+        result.kind = request.kind;
+        result.id = request.id;
+        result.waitMs = start - request.queuedAt;
+        serve(request, result);
+        result.serviceMs = millis() - start;
+        _busy = false;
+
+        _completed++;
+        _totalWaitMs += result.waitMs;
+        _maxWaitMs = max(_maxWaitMs, result.waitMs);
+        _totalServiceMs += result.serviceMs;
+        _maxServiceMs = max(_maxServiceMs, result.serviceMs);
+
+        // loop() holds at most one request of each kind in flight, so this never waits long
+        xQueueSend(_results, &result, portMAX_DELAY);
+    }
+}
+
+void NetWorker::serve(const NetRequest &request, NetResult &result)
+{
+    switch (request.kind)
+    {
+    case NetRequestKind::Mutation:
+        result.status = gameApi.postJson(request.path, String(request.payload), logApiReply, (void *)"[NetWorker]",
+                                         request.key);
+        break;
+    case NetRequestKind::RefreshNames:
+        result.status = NameIndex::fetch(result);
+        break;
+    }
+}
+
+String NetWorker::statsJson() const
+{
+    String json = "{";
+    json += "\"depth\":" + String(_requests ? uxQueueMessagesWaiting(_requests) : 0) + ",";
+    json += "\"maxDepth\":" + String(_maxDepth) + ",";
+    json += "\"busy\":" + String(_busy ? "true" : "false") + ",";
+    json += "\"submitted\":" + String(_submitted) + ",";
+    json += "\"queueFull\":" + String(_queueFull) + ",";
+    json += "\"completed\":" + String(_completed) + ",";
+    json += "\"avgWaitMs\":" + String(_completed ? _totalWaitMs / _completed : 0) + ",";
+    json += "\"maxWaitMs\":" + String(_maxWaitMs) + ",";
+    json += "\"avgServiceMs\":" + String(_completed ? _totalServiceMs / _completed : 0) + ",";
+    json += "\"maxServiceMs\":" + String(_maxServiceMs) + "}";
+    return json;
+}
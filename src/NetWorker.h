@@ -0,0 +1,89 @@
+// NetWorker.h
+#ifndef NETWORKER_H
+#define NETWORKER_H
+
+#include <Arduino.h>
+#include "ApiJournal.h"
+
+#define NET_WORKER_CORE 0          // Wi-Fi/LwIP core; loop() runs on ARDUINO_RUNNING_CORE
+#define NET_WORKER_STACK 8192      // HTTP client plus one streamed JSON element
+#define NET_WORKER_PRIORITY 1
+#define NET_QUEUE_DEPTH 4          // Requests waiting for the worker
+#define NET_WORKER_IDLE_MS 5000UL  // Housekeeping interval while no request comes in
+
+enum class NetRequestKind : uint8_t
+{
+    Mutation,    // a journal entry: POST with an idempotency key
+    RefreshNames // download the creature name list
+};
+
+struct NetRequest
+{
+    NetRequestKind kind;
+    uint32_t id;      // journal sequence number, echoed in the result
+    const char *path; // string literal, so it outlives the request
+    char key[24];
+    char payload[JOURNAL_MAX_PAYLOAD + 1];
+    unsigned long queuedAt;
+};
+
+struct NetResult
+{
+    NetRequestKind kind;
+    uint32_t id;
+    int status; // HTTP status, or a negative HTTP_ERROR_* code
+
+    // RefreshNames: sorted name hashes on the heap, owned by whoever takes
+    // the result (nullptr when the refresh failed)
+    uint32_t *names;
+    uint16_t nameCount;
+    uint32_t namesDropped;
+
+    uint32_t waitMs;    // in the request queue
+    uint32_t serviceMs; // on the network
+};
+
+// Runs all game API traffic on its own FreeRTOS task, pinned to the core
+// the Wi-Fi stack runs on, so a slow server or a cold start never holds up
+// loop(), the readers or the display. loop() submits typed requests without
+// blocking and picks up completions from a result queue; the game state
+// they touch (journal, name index) is only ever changed from loop(). Only
+// the worker uses gameApi once it has started.
+class NetWorker
+{
+public:
+    NetWorker();
+
+    void begin(); // create the queues and start the task
+
+    // Queue a request; false at once if the queue is full
+    bool submit(NetRequest &request);
+
+    // Next completed request, if any; never blocks
+    bool poll(NetResult &result);
+
+    String statsJson() const;
+
+private:
+    static void taskMain(void *arg);
+    void run();
+    void serve(const NetRequest &request, NetResult &result);
+
+    QueueHandle_t _requests;
+    QueueHandle_t _results;
+    TaskHandle_t _task;
+
+    volatile bool _busy;
+    uint32_t _submitted;
+    uint32_t _queueFull;
+    uint32_t _completed;
+    uint32_t _maxDepth;
+    uint32_t _totalWaitMs;
+    uint32_t _maxWaitMs;
+    uint32_t _totalServiceMs;
+    uint32_t _maxServiceMs;
+};
+
+extern NetWorker netWorker;
+
+#endif // NETWORKER_H
@@ -0,0 +1,74 @@
+#include "ProfileBindings.h"
+#include "RFIDData.h"
+
+void profileToJson(const ProfileFields &fields, JsonObject obj)
+{
+#define PROFILE_JSON(member, type, bits, max, jsonKey, jsonMask, formParam) obj[jsonKey] = fields.member & (jsonMask);
+    PROFILE_FIELDS(PROFILE_JSON)
+#undef PROFILE_JSON
+    obj[PROFILE_JSON_NAME_KEY] = (const char *)fields.name;
+}
+
+// The form sends a hidden "0" before each checkbox, so a ticked box arrives
+// as two parameters; look for the "1"
+static bool formFlag(AsyncWebServerRequest *request, const char *param)
+{
+    for (size_t i = 0; i < request->params(); i++)
+    {
+        AsyncWebParameter *p = request->getParam(i);
+        if (p->name() == param && p->value() == "1")
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// One numeric form parameter, range-checked before it is narrowed
+static ProfileError bindFormField(AsyncWebServerRequest *request, const char *param, long max, long &value)
+{
+    if (param == nullptr)
+    {
+        return ProfileError::Ok; // filled some other way
+    }
+    if (!request->hasParam(param, true))
+    {
+        return ProfileError::MissingField;
+    }
+    value = request->getParam(param, true)->value().toInt();
+    return (value < 0 || value > max) ? ProfileError::OutOfRange : ProfileError::Ok;
+}
+
+ProfileError bindProfileForm(AsyncWebServerRequest *request, ProfileFields &fields)
+{
+    memset(&fields, 0, sizeof(fields));
+
+    long value = 0;
+    ProfileError error;
+#define PROFILE_BIND(member, type, bits, max, jsonKey, jsonMask, formParam)                \
+    value = 0;                                                                             \
+    error = bindFormField(request, formParam, ProfileMax::member, value);                  \
+    if (error != ProfileError::Ok)                                                         \
+    {                                                                                      \
+        return error;                                                                      \
+    }                                                                                      \
+    fields.member = (type)value;
+    PROFILE_FIELDS(PROFILE_BIND)
+#undef PROFILE_BIND
+
+    if (!request->hasParam(PROFILE_FORM_NAME_PARAM, true))
+    {
+        return ProfileError::MissingField;
+    }
+    const String &name = request->getParam(PROFILE_FORM_NAME_PARAM, true)->value();
+    if (name.length() > PROFILE_NAME_MAX)
+    {
+        return ProfileError::BadName;
+    }
+    strncpy(fields.name, name.c_str(), PROFILE_NAME_MAX);
+
+    fields.bools = encodeBools(formFlag(request, "A"), formFlag(request, "B"),
+                               formFlag(request, "C"), formFlag(request, "D"));
+
+    return validateProfile(fields);
+}
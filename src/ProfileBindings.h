@@ -0,0 +1,23 @@
+// ProfileBindings.h
+#ifndef PROFILEBINDINGS_H
+#define PROFILEBINDINGS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include "ProfileCodec.h"
+
+#define PROFILE_JSON_NAME_KEY "customName"
+#define PROFILE_FORM_NAME_PARAM "name"
+
+// API and web form views of a profile, generated from PROFILE_FIELDS
+
+// Every field under its jsonKey (masked), plus the name
+void profileToJson(const ProfileFields &fields, JsonObject obj);
+
+// Setup form POST into fields: the formParam fields, the name and the A-D
+// checkboxes. Validated against the schema bounds; fields is only complete
+// when Ok comes back.
+ProfileError bindProfileForm(AsyncWebServerRequest *request, ProfileFields &fields);
+
+#endif // PROFILEBINDINGS_H
@@ -0,0 +1,110 @@
+#include "ProfileCache.h"
+
+ProfileCache profileCache;
+
+static bool sameUid(const MFRC522::Uid &a, const MFRC522::Uid &b)
+{
+    return a.size == b.size && memcmp(a.uidByte, b.uidByte, a.size) == 0;
+}
+
+ProfileCache::ProfileCache(unsigned long ttlMs)
+    : _ttlMs(ttlMs), _hits(0), _misses(0), _evictions(0)
+{
+    clear();
+}
+
+ProfileCacheEntry *ProfileCache::find(const MFRC522::Uid &uid)
+{
+    for (byte i = 0; i < PROFILE_CACHE_SIZE; i++)
+    {
+        if (_entries[i].valid && sameUid(_entries[i].uid, uid))
+        {
+            return &_entries[i];
+        }
+    }
+    return nullptr;
+}
+
+const ProfileCacheEntry *ProfileCache::lookup(const MFRC522::Uid &uid)
+{
+    ProfileCacheEntry *entry = find(uid);
+    if (entry && millis() - entry->storedAt >= _ttlMs)
+    {
+        entry->valid = false; // Expired
+        entry = nullptr;
+    }
+
+    if (!entry)
+    {
+        _misses++;
+        return nullptr;
+    }
+
+    _hits++;
+    entry->lastUsed = millis();
+    return entry;
+}
+
+void ProfileCache::store(const MFRC522::Uid &uid, const byte *block, const Creature &creature)
+{
+    ProfileCacheEntry *entry = find(uid);
+    if (!entry)
+    {
+        // Take a free slot, otherwise evict the least recently used one
+        entry = &_entries[0];
+        for (byte i = 0; i < PROFILE_CACHE_SIZE; i++)
+        {
+            if (!_entries[i].valid)
+            {
+                entry = &_entries[i];
+                break;
+            }
+            if (_entries[i].lastUsed < entry->lastUsed)
+            {
+                entry = &_entries[i];
+            }
+        }
+        if (entry->valid)
+        {
+            _evictions++;
+        }
+    }
+
+    entry->uid = uid;
+    memcpy(entry->block, block, sizeof(entry->block));
+    entry->creature = creature;
+    entry->storedAt = millis();
+    entry->lastUsed = entry->storedAt;
+    entry->valid = true;
+}
+
+void ProfileCache::invalidate(const MFRC522::Uid &uid)
+{
+    ProfileCacheEntry *entry = find(uid);
+    if (entry)
+    {
+        entry->valid = false;
+    }
+}
+
+void ProfileCache::clear()
+{
+    for (byte i = 0; i < PROFILE_CACHE_SIZE; i++)
+    {
+        _entries[i].valid = false;
+        _entries[i].lastUsed = 0;
+    }
+}
+
+uint8_t ProfileCache::size() const
+{
+    uint8_t count = 0;
+    for (byte i = 0; i < PROFILE_CACHE_SIZE; i++)
+    {
+        if (_entries[i].valid)
+        {
+            count++;
+        }
+    }
+    return count;
+}
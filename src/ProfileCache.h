@@ -0,0 +1,54 @@
+// ProfileCache.h
+#ifndef PROFILECACHE_H
+#define PROFILECACHE_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFIDData.h"
+
+#define PROFILE_CACHE_SIZE 8          // Number of cards kept
+#define PROFILE_CACHE_TTL_MS 30000UL  // How long a cached profile stays valid
+
+struct ProfileCacheEntry
+{
+    MFRC522::Uid uid;
+    byte block[16];    // Raw profile block as read from the card
+    Creature creature; // Already decoded
+    unsigned long storedAt;
+    unsigned long lastUsed;
+    bool valid;
+};
+
+// Small LRU of decoded profiles keyed by card UID, so a card lifted and
+// tapped again within the TTL is served from RAM without auth or read.
+class ProfileCache
+{
+public:
+    explicit ProfileCache(unsigned long ttlMs = PROFILE_CACHE_TTL_MS);
+
+    // nullptr on miss or expired entry; counts hits/misses
+    const ProfileCacheEntry *lookup(const MFRC522::Uid &uid);
+    void store(const MFRC522::Uid &uid, const byte *block, const Creature &creature);
+    void invalidate(const MFRC522::Uid &uid);
+    void clear();
+
+    void setTtl(unsigned long ttlMs) { _ttlMs = ttlMs; }
+    unsigned long ttl() const { return _ttlMs; }
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+    uint32_t evictions() const { return _evictions; }
+    uint8_t size() const;
+
+private:
+    ProfileCacheEntry *find(const MFRC522::Uid &uid);
+
+    ProfileCacheEntry _entries[PROFILE_CACHE_SIZE];
+    unsigned long _ttlMs;
+    uint32_t _hits;
+    uint32_t _misses;
+    uint32_t _evictions;
+};
+
+extern ProfileCache profileCache;
+
+#endif // PROFILECACHE_H
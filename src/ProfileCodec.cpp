@@ -0,0 +1,337 @@
+#include "ProfileCodec.h"
+#include <string.h>
+
+#define PACKED_START 1
+#define CRC_OFFSET 14
+#define NAME_END 0 // 6-bit code that ends the name early
+
+// Sequential bit access over the packed bytes, LSB first
+struct BitCursor
+{
+    uint8_t *bytes;
+    uint8_t bit;
+};
+
+static void putBits(BitCursor &cursor, uint32_t value, uint8_t width)
+{
+    for (uint8_t i = 0; i < width; i++, cursor.bit++)
+    {
+        if (value & (1UL << i))
+        {
+            cursor.bytes[cursor.bit / 8] |= 1 << (cursor.bit % 8);
+        }
+    }
+}
+
+static uint32_t getBits(BitCursor &cursor, uint8_t width)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < width; i++, cursor.bit++)
+    {
+        if (cursor.bytes[cursor.bit / 8] & (1 << (cursor.bit % 8)))
+        {
+            value |= 1UL << i;
+        }
+    }
+    return value;
+}
+
+// 1-26 A-Z, 27-52 a-z, 53-62 0-9, 63 space; 0 = no character
+static uint8_t charToCode(char c)
+{
+    if (c >= 'A' && c <= 'Z')
+    {
+        return 1 + (c - 'A');
+    }
+    if (c >= 'a' && c <= 'z')
+    {
+        return 27 + (c - 'a');
+    }
+    if (c >= '0' && c <= '9')
+    {
+        return 53 + (c - '0');
+    }
+    return c == ' ' ? 63 : NAME_END;
+}
+
+static char codeToChar(uint8_t code)
+{
+    if (code >= 1 && code <= 26)
+    {
+        return 'A' + (code - 1);
+    }
+    if (code >= 27 && code <= 52)
+    {
+        return 'a' + (code - 27);
+    }
+    if (code >= 53 && code <= 62)
+    {
+        return '0' + (code - 53);
+    }
+    return code == 63 ? ' ' : '\0';
+}
+
+static void trimName(char *name)
+{
+    size_t length = strlen(name);
+    while (length > 0 && name[length - 1] == ' ')
+    {
+        name[--length] = '\0';
+    }
+}
+
+static bool readPair(const uint8_t *digits, uint8_t &value)
+{
+    if (digits[0] < '0' || digits[0] > '9' || digits[1] < '0' || digits[1] > '9')
+    {
+        return false;
+    }
+    value = (digits[0] - '0') * 10 + (digits[1] - '0');
+    return true;
+}
+
+uint16_t profileCrc16(const uint8_t *data, uint8_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static ProfileError decodeBinaryV1(const uint8_t *block, ProfileFields &out)
+{
+    uint16_t stored = (block[CRC_OFFSET] << 8) | block[CRC_OFFSET + 1];
+    if (profileCrc16(block, CRC_OFFSET) != stored)
+    {
+        return ProfileError::BadCrc;
+    }
+
+    BitCursor cursor = {const_cast<uint8_t *>(block + PACKED_START), 0};
+#define PROFILE_UNPACK(member, type, bits, max, jsonKey, jsonMask, formParam) out.member = getBits(cursor, bits);
+    PROFILE_FIELDS(PROFILE_UNPACK)
+#undef PROFILE_UNPACK
+    for (uint8_t i = 0; i < PROFILE_NAME_MAX; i++)
+    {
+        char c = codeToChar(getBits(cursor, PROFILE_NAME_CHAR_BITS));
+        if (c == '\0')
+        {
+            break;
+        }
+        out.name[i] = c;
+    }
+    trimName(out.name);
+    return ProfileError::Ok;
+}
+
+static ProfileError decodeAscii(const uint8_t *block, ProfileFields &out)
+{
+    uint8_t age, coins, creatureType, bools;
+    if (!readPair(block, age) || !readPair(block + 2, coins) ||
+        !readPair(block + 4, creatureType) || !readPair(block + 6, bools))
+    {
+        return ProfileError::BadDigits;
+    }
+    out.age = age;
+    out.coins = coins;
+    out.creatureType = creatureType;
+    out.bools = bools;
+
+    // Name runs to the first NUL; anything past six characters is dropped
+    const uint8_t *name = block + PROFILE_DIGITS + 1;
+    for (uint8_t i = 0; i < PROFILE_ASCII_NAME_MAX && name[i] != '\0'; i++)
+    {
+        out.name[i] = (char)name[i];
+    }
+    trimName(out.name);
+    return ProfileError::Ok;
+}
+
+static bool isBinaryV1(const uint8_t *block)
+{
+    return block[0] == PROFILE_FORMAT_V1;
+}
+
+static bool isAscii(const uint8_t *block)
+{
+    return (block[0] & PROFILE_FORMAT_MASK) != PROFILE_FORMAT_BINARY && block[PROFILE_DIGITS] == PROFILE_SEPARATOR;
+}
+
+// Every record layout this firmware reads, indexed by version. A new layout
+// adds a line here and an upgrade step in CardMigration.cpp.
+struct RecordDecoder
+{
+    uint8_t version;
+    const char *name;
+    bool (*matches)(const uint8_t *block);
+    ProfileError (*decode)(const uint8_t *block, ProfileFields &out);
+};
+
+static const RecordDecoder decoders[PROFILE_VERSION_COUNT] = {
+    {PROFILE_VERSION_ASCII, "ascii", isAscii, decodeAscii},
+    {PROFILE_VERSION_V1, "v1", isBinaryV1, decodeBinaryV1},
+};
+
+uint8_t profileVersion(const uint8_t *block)
+{
+    for (const RecordDecoder &decoder : decoders)
+    {
+        if (decoder.matches(block))
+        {
+            return decoder.version;
+        }
+    }
+    return (block[0] & PROFILE_FORMAT_MASK) == PROFILE_FORMAT_BINARY ? PROFILE_VERSION_UNKNOWN : PROFILE_VERSION_NONE;
+}
+
+const char *profileVersionName(uint8_t version)
+{
+    for (const RecordDecoder &decoder : decoders)
+    {
+        if (decoder.version == version)
+        {
+            return decoder.name;
+        }
+    }
+    return version == PROFILE_VERSION_NONE ? "none" : "unknown";
+}
+
+// A binary record with a bit error in its format nibble: the CRC still
+// matches once the nibble is put back. Reading it as blank would offer a
+// player's card for overwriting.
+static bool damagedBinaryFormat(const uint8_t *block)
+{
+    uint8_t repaired[CRC_OFFSET];
+    memcpy(repaired, block, CRC_OFFSET);
+    repaired[0] = PROFILE_FORMAT_BINARY | (block[0] & ~PROFILE_FORMAT_MASK);
+    uint16_t crc = profileCrc16(repaired, CRC_OFFSET);
+    return block[CRC_OFFSET] == (crc >> 8) && block[CRC_OFFSET + 1] == (crc & 0xFF);
+}
+
+ProfileError decodeProfile(const uint8_t *block, ProfileFields &out)
+{
+    memset(&out, 0, sizeof(out));
+
+    uint8_t version = profileVersion(block);
+    if (version == PROFILE_VERSION_NONE)
+    {
+        return damagedBinaryFormat(block) ? ProfileError::BadCrc : ProfileError::Blank;
+    }
+    if (version == PROFILE_VERSION_UNKNOWN)
+    {
+        return ProfileError::UnknownVersion;
+    }
+
+    ProfileError error = decoders[version].decode(block, out);
+    if (error != ProfileError::Ok)
+    {
+        memset(&out, 0, sizeof(out));
+    }
+    return error;
+}
+
+ProfileError validateProfile(const ProfileFields &fields)
+{
+#define PROFILE_CHECK(member, type, bits, max, jsonKey, jsonMask, formParam) \
+    if (fields.member > ProfileMax::member)                                 \
+    {                                                                       \
+        return ProfileError::OutOfRange;                                    \
+    }
+    PROFILE_FIELDS(PROFILE_CHECK)
+#undef PROFILE_CHECK
+
+    size_t length = strnlen(fields.name, sizeof(fields.name));
+    if (length > PROFILE_NAME_MAX)
+    {
+        return ProfileError::BadName;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (charToCode(fields.name[i]) == NAME_END)
+        {
+            return ProfileError::BadName;
+        }
+    }
+    // decodeProfile trims trailing spaces, so "Bob " would read back as "Bob"
+    if (length > 0 && fields.name[length - 1] == ' ')
+    {
+        return ProfileError::BadName;
+    }
+    return ProfileError::Ok;
+}
+
+ProfileError encodeProfile(const ProfileFields &in, uint8_t *block)
+{
+    ProfileError error = validateProfile(in);
+    if (error != ProfileError::Ok)
+    {
+        return error;
+    }
+
+    uint8_t record[PROFILE_BLOCK_SIZE];
+    memset(record, 0, sizeof(record));
+    record[0] = PROFILE_FORMAT_V1;
+
+    BitCursor cursor = {record + PACKED_START, 0};
+#define PROFILE_PACK(member, type, bits, max, jsonKey, jsonMask, formParam) putBits(cursor, in.member, bits);
+    PROFILE_FIELDS(PROFILE_PACK)
+#undef PROFILE_PACK
+    for (size_t i = 0; in.name[i] != '\0'; i++)
+    {
+        putBits(cursor, charToCode(in.name[i]), PROFILE_NAME_CHAR_BITS);
+    }
+
+    uint16_t crc = profileCrc16(record, CRC_OFFSET);
+    record[CRC_OFFSET] = crc >> 8;
+    record[CRC_OFFSET + 1] = crc & 0xFF;
+    memcpy(block, record, PROFILE_BLOCK_SIZE);
+    return ProfileError::Ok;
+}
+
+void sanitizeProfileName(char *name)
+{
+    uint8_t kept = 0;
+    for (uint8_t i = 0; name[i] != '\0'; i++)
+    {
+        if (kept < PROFILE_NAME_MAX && charToCode(name[i]) != NAME_END)
+        {
+            name[kept++] = name[i];
+        }
+    }
+    name[kept] = '\0';
+    trimName(name); // dropping a character can leave a trailing space
+}
+
+uint32_t profileDigits(const ProfileFields &fields)
+{
+    return fields.age % 100 * 1000000UL + fields.coins % 100 * 10000UL + fields.creatureType % 100 * 100UL + fields.bools % 100;
+}
+
+const char *profileErrorName(ProfileError error)
+{
+    switch (error)
+    {
+    case ProfileError::Ok:
+        return "ok";
+    case ProfileError::Blank:
+        return "blank";
+    case ProfileError::BadDigits:
+        return "badDigits";
+    case ProfileError::BadCrc:
+        return "badCrc";
+    case ProfileError::UnknownVersion:
+        return "unknownVersion";
+    case ProfileError::BadName:
+        return "badName";
+    case ProfileError::OutOfRange:
+        return "outOfRange";
+    case ProfileError::MissingField:
+        return "missingField";
+    }
+    return "unknown";
+}
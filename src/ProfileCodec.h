@@ -0,0 +1,78 @@
+// ProfileCodec.h
+#ifndef PROFILECODEC_H
+#define PROFILECODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ProfileSchema.h"
+
+#define PROFILE_BLOCK_SIZE 16
+
+// Record versions. Every version this firmware reads has a decoder in
+// ProfileCodec.cpp; cards are only ever written at PROFILE_VERSION_CURRENT,
+// and CardMigration.cpp holds the steps that bring older cards up to it.
+#define PROFILE_VERSION_ASCII 0 // legacy "AACCTTBB%NAME"
+#define PROFILE_VERSION_V1 1    // first binary record
+#define PROFILE_VERSION_CURRENT PROFILE_VERSION_V1
+#define PROFILE_VERSION_COUNT 2
+#define PROFILE_VERSION_NONE 0xFE    // blank or foreign block
+#define PROFILE_VERSION_UNKNOWN 0xFF // binary record from newer firmware
+
+// Binary record:
+//   byte 0      format byte, 0xB0 | version (never an ASCII digit)
+//   bytes 1-13  bit-packed, LSB first: the PROFILE_FIELDS in order at their
+//               widths, then the name at 6 bits a character
+//   bytes 14-15 CRC-16/CCITT-FALSE over bytes 0-13, big endian
+#define PROFILE_FORMAT_MASK 0xF0
+#define PROFILE_FORMAT_BINARY 0xB0
+#define PROFILE_FORMAT_V1 (PROFILE_FORMAT_BINARY | PROFILE_VERSION_V1)
+
+// Legacy ASCII record, read only: "AACCTTBB%NAME" zero padded
+#define PROFILE_DIGITS 8
+#define PROFILE_SEPARATOR '%'
+#define PROFILE_ASCII_NAME_MAX 6
+
+enum class ProfileError : uint8_t
+{
+    Ok,
+    Blank,          // no profile on the card
+    BadDigits,      // ASCII: a non-digit in AACCTTBB
+    BadCrc,         // binary: corrupt block or a bad read
+    UnknownVersion, // binary: written by newer firmware
+    BadName,        // encode: a character outside A-Z a-z 0-9 space, a trailing space, or too long
+    OutOfRange,     // encode: a field above its ProfileMax bound
+    MissingField    // form: a required parameter was not sent
+};
+
+// Record version a block holds, from its framing only (no CRC check)
+uint8_t profileVersion(const uint8_t *block);
+const char *profileVersionName(uint8_t version);
+
+// Parse any record version this firmware reads. out is zeroed first, so it is safe to use even when
+// an error comes back.
+ProfileError decodeProfile(const uint8_t *block, ProfileFields &out);
+
+// Bounds and name characters, as encodeProfile checks them
+ProfileError validateProfile(const ProfileFields &fields);
+
+// Build the binary record. The block is left untouched on an error.
+ProfileError encodeProfile(const ProfileFields &in, uint8_t *block);
+
+// The fields as the old eight-digit AACCTTBB number, for logs
+uint32_t profileDigits(const ProfileFields &fields);
+
+// Drop the characters the binary record cannot hold, cut to PROFILE_NAME_MAX
+// and trim trailing spaces, in place
+void sanitizeProfileName(char *name);
+
+// A block that holds a profile this firmware cannot use. Never treat it as
+// blank, or a bad read would offer the card for overwriting.
+inline bool profileRejected(ProfileError error)
+{
+    return error == ProfileError::BadCrc || error == ProfileError::UnknownVersion;
+}
+
+uint16_t profileCrc16(const uint8_t *data, uint8_t length);
+const char *profileErrorName(ProfileError error);
+
+#endif // PROFILECODEC_H
@@ -0,0 +1,62 @@
+// ProfileSchema.h
+#ifndef PROFILESCHEMA_H
+#define PROFILESCHEMA_H
+
+#include <stdint.h> // no Arduino.h: the codec also builds off-device
+
+#define PROFILE_NAME_MAX 12
+
+// Every numeric profile field, in card bit order. The card codec, the
+// validation bounds, the JSON serializer and the form binder are all
+// generated from this list, so a new field is one line here (plus a
+// format version bump if it changes the card layout).
+//
+//   X(member, type, bits, max, jsonKey, jsonMask, formParam)
+//
+// jsonMask is applied before the value goes to the API. formParam is the
+// setup form's parameter, or nullptr for a field the form fills another way.
+#define PROFILE_FIELDS(X)                                                 \
+    X(age, uint8_t, 7, 127, "age", 0xFFFF, "age")                         \
+    X(coins, uint16_t, 10, 1023, "coins", 0xFFFF, "coins")                \
+    X(creatureType, uint8_t, 6, 63, "creatureType", 0xFFFF, "creatureType") \
+    X(bools, uint8_t, 8, 255, "intVal", 0x0F, nullptr) /* A-D checkboxes; upper bits are storage flags */
+
+// One profile as plain fields. Nothing here touches the heap.
+struct ProfileFields
+{
+#define PROFILE_MEMBER(member, type, bits, max, jsonKey, jsonMask, formParam) type member;
+    PROFILE_FIELDS(PROFILE_MEMBER)
+#undef PROFILE_MEMBER
+    char name[PROFILE_NAME_MAX + 1];
+};
+
+// Upper bound of each field, e.g. ProfileMax::age
+namespace ProfileMax
+{
+#define PROFILE_MAX(member, type, bits, max, jsonKey, jsonMask, formParam) constexpr uint16_t member = max;
+    PROFILE_FIELDS(PROFILE_MAX)
+#undef PROFILE_MAX
+}
+
+// Bits the numeric fields take in the binary record
+constexpr uint8_t profileFieldBits()
+{
+    return 0
+#define PROFILE_BITS(member, type, bits, max, jsonKey, jsonMask, formParam) +bits
+        PROFILE_FIELDS(PROFILE_BITS)
+#undef PROFILE_BITS
+        ;
+}
+
+#define PROFILE_NAME_CHAR_BITS 6
+#define PROFILE_PACKED_BITS 104 // bytes 1-13 of the binary record
+
+static_assert(profileFieldBits() + PROFILE_NAME_MAX * PROFILE_NAME_CHAR_BITS <= PROFILE_PACKED_BITS,
+              "Profile fields no longer fit the binary record");
+
+#define PROFILE_CHECK_MAX(member, type, bits, max, jsonKey, jsonMask, formParam) \
+    static_assert((max) < (1UL << (bits)), "Profile field " #member " max needs more bits");
+PROFILE_FIELDS(PROFILE_CHECK_MAX)
+#undef PROFILE_CHECK_MAX
+
+#endif // PROFILESCHEMA_H
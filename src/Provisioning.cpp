@@ -0,0 +1,262 @@
+#include "Provisioning.h"
+#include "CoinStore.h"
+
+ProvisionQueue provisionQueue;
+
+ProvisionQueue::ProvisionQueue()
+    : _count(0), _written(0), _failed(0), _firstWriteAt(0), _lastWriteAt(0), _generation(0), _mutex(nullptr)
+{
+}
+
+void ProvisionQueue::begin()
+{
+    _mutex = xSemaphoreCreateMutex();
+}
+
+void ProvisionQueue::lock()
+{
+    if (_mutex)
+    {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+    }
+}
+
+void ProvisionQueue::unlock()
+{
+    if (_mutex)
+    {
+        xSemaphoreGive(_mutex);
+    }
+}
+
+bool ProvisionQueue::add(const ProfileFields &data)
+{
+    lock();
+    bool added = _count < PROVISION_QUEUE_SIZE;
+    if (added)
+    {
+        ProvisionJob &job = _jobs[_count++];
+        job.data = data;
+        job.status = ProvisionStatus::Queued;
+        job.attempts = 0;
+        job.uid.size = 0;
+        job.finishedAt = 0;
+    }
+    unlock();
+
+    if (!added)
+    {
+        Serial.println("[ProvisionQueue] Queue full");
+    }
+    return added;
+}
+
+uint8_t ProvisionQueue::addList(const String &list)
+{
+    uint8_t added = 0;
+    int lineStart = 0;
+    while (lineStart < (int)list.length())
+    {
+        int lineEnd = list.indexOf('\n', lineStart);
+        if (lineEnd == -1)
+        {
+            lineEnd = list.length();
+        }
+        String line = list.substring(lineStart, lineEnd);
+        line.trim();
+        lineStart = lineEnd + 1;
+
+        // name,age,coins,creatureType,bools
+        int c1 = line.indexOf(',');
+        int c2 = line.indexOf(',', c1 + 1);
+        int c3 = line.indexOf(',', c2 + 1);
+        int c4 = line.indexOf(',', c3 + 1);
+        if (c1 <= 0 || c2 == -1 || c3 == -1 || c4 == -1)
+        {
+            if (line.length() > 0)
+            {
+                Serial.println("[ProvisionQueue] Skipping bad line: " + line);
+            }
+            continue;
+        }
+
+        ProfileFields data;
+        memset(&data, 0, sizeof(data));
+        line.substring(0, c1).toCharArray(data.name, sizeof(data.name));
+        sanitizeProfileName(data.name);
+        data.age = constrain(line.substring(c1 + 1, c2).toInt(), 0, (long)ProfileMax::age);
+        data.coins = constrain(line.substring(c2 + 1, c3).toInt(), 0, (long)ProfileMax::coins);
+        data.creatureType = constrain(line.substring(c3 + 1, c4).toInt(), 0, (long)ProfileMax::creatureType);
+        data.bools = line.substring(c4 + 1).toInt() & BOOLS_MASK;
+        if (!add(data))
+        {
+            break;
+        }
+        added++;
+    }
+    return added;
+}
+
+void ProvisionQueue::clear()
+{
+    lock();
+    _count = 0;
+    _written = 0;
+    _failed = 0;
+    _firstWriteAt = 0;
+    _lastWriteAt = 0;
+    _generation++; // claims still held by readers are void
+    unlock();
+}
+
+bool ProvisionQueue::claimed(int index, uint16_t generation) const
+{
+    return generation == _generation && index >= 0 && index < _count &&
+           _jobs[index].status == ProvisionStatus::Writing;
+}
+
+bool ProvisionQueue::isClaimed(int index, uint16_t generation)
+{
+    lock();
+    bool current = claimed(index, generation);
+    unlock();
+    return current;
+}
+
+int ProvisionQueue::claim(ProfileFields &data, uint16_t &generation)
+{
+    int index = -1;
+    lock();
+    generation = _generation;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (_jobs[i].status == ProvisionStatus::Queued)
+        {
+            index = i;
+            _jobs[i].status = ProvisionStatus::Writing;
+            data = _jobs[i].data;
+            break;
+        }
+    }
+    unlock();
+    return index;
+}
+
+void ProvisionQueue::release(int index, uint16_t generation)
+{
+    lock();
+    if (claimed(index, generation))
+    {
+        _jobs[index].status = ProvisionStatus::Queued;
+    }
+    unlock();
+}
+
+void ProvisionQueue::markWritten(int index, uint16_t generation, const MFRC522::Uid &uid)
+{
+    lock();
+    if (claimed(index, generation))
+    {
+        ProvisionJob &job = _jobs[index];
+        job.status = ProvisionStatus::Written;
+        job.attempts++;
+        job.uid = uid;
+        job.finishedAt = millis();
+        _written++;
+        if (_firstWriteAt == 0)
+        {
+            _firstWriteAt = job.finishedAt;
+        }
+        _lastWriteAt = job.finishedAt;
+    }
+    unlock();
+}
+
+void ProvisionQueue::markFailed(int index, uint16_t generation)
+{
+    lock();
+    if (claimed(index, generation))
+    {
+        ProvisionJob &job = _jobs[index];
+        if (++job.attempts >= PROVISION_MAX_ATTEMPTS)
+        {
+            job.status = ProvisionStatus::Failed;
+            job.finishedAt = millis();
+            _failed++;
+        }
+        else
+        {
+            job.status = ProvisionStatus::Queued;
+        }
+    }
+    unlock();
+}
+
+bool ProvisionQueue::hasQueued()
+{
+    bool queued = false;
+    lock();
+    for (uint8_t i = 0; i < _count && !queued; i++)
+    {
+        queued = _jobs[i].status == ProvisionStatus::Queued || _jobs[i].status == ProvisionStatus::Writing;
+    }
+    unlock();
+    return queued;
+}
+
+float ProvisionQueue::cardsPerMinute()
+{
+    lock();
+    float perMinute = rate();
+    unlock();
+    return perMinute;
+}
+
+float ProvisionQueue::rate() const
+{
+    // Rate between the first and last written card
+    if (_written < 2 || _lastWriteAt == _firstWriteAt)
+    {
+        return 0.0f;
+    }
+    return (_written - 1) * 60000.0f / (_lastWriteAt - _firstWriteAt);
+}
+
+String ProvisionQueue::statusJson()
+{
+    lock();
+    String json = "{";
+    json += "\"queued\":" + String(_count - _written - _failed) + ",";
+    json += "\"written\":" + String(_written) + ",";
+    json += "\"failed\":" + String(_failed) + ",";
+    json += "\"cardsPerMinute\":" + String(rate()) + ",";
+    json += "\"jobs\":[";
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        const ProvisionJob &job = _jobs[i];
+        const char *status = job.status == ProvisionStatus::Written   ? "written"
+                             : job.status == ProvisionStatus::Failed  ? "failed"
+                             : job.status == ProvisionStatus::Writing ? "writing"
+                                                                      : "queued";
+        if (i > 0)
+        {
+            json += ",";
+        }
+        json += "{\"name\":\"" + String(job.data.name) + "\",";
+        json += "\"status\":\"" + String(status) + "\",";
+        json += "\"attempts\":" + String(job.attempts) + ",";
+        json += "\"uid\":\"";
+        for (byte b = 0; b < job.uid.size; b++)
+        {
+            if (job.uid.uidByte[b] < 0x10)
+            {
+                json += "0";
+            }
+            json += String(job.uid.uidByte[b], HEX);
+        }
+        json += "\"}";
+    }
+    json += "]}";
+    unlock();
+    return json;
+}
@@ -0,0 +1,77 @@
+// Provisioning.h
+#ifndef PROVISIONING_H
+#define PROVISIONING_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFIDData.h"
+
+#define PROVISION_QUEUE_SIZE 40   // A class set plus spares
+#define PROVISION_MAX_ATTEMPTS 3  // Write attempts (cards presented) per job
+
+enum class ProvisionStatus : uint8_t
+{
+    Queued,
+    Writing, // claimed by a reader, waiting for its card
+    Written,
+    Failed
+};
+
+struct ProvisionJob
+{
+    ProfileFields data;
+    ProvisionStatus status;
+    uint8_t attempts;
+    MFRC522::Uid uid; // card the job ended up on
+    unsigned long finishedAt;
+};
+
+// In-RAM queue of profiles to write to successive blank cards without a
+// reboot between cards. Filled from the web server task, drained by loop(),
+// so every access goes through a mutex.
+class ProvisionQueue
+{
+public:
+    ProvisionQueue();
+    void begin(); // creates the mutex, call from setup()
+
+    bool add(const ProfileFields &data);
+    uint8_t addList(const String &list); // one "name,age,coins,creatureType,bools" per line
+    void clear();
+
+    // Claim the next queued job for one reader: returns its index (and a copy
+    // of its data), -1 if none. Each reader pad claims its own job.
+    // clear() starts a new generation; calls that pass a claim from an older
+    // one are ignored, so a cleared job can never land on a new job's slot.
+    int claim(ProfileFields &data, uint16_t &generation);
+    bool isClaimed(int index, uint16_t generation); // claim still stands
+    void release(int index, uint16_t generation); // back to the queue without counting an attempt
+    void markWritten(int index, uint16_t generation, const MFRC522::Uid &uid);
+    void markFailed(int index, uint16_t generation); // re-queued until PROVISION_MAX_ATTEMPTS
+
+    bool hasQueued();
+    uint8_t written() const { return _written; }
+    uint8_t failed() const { return _failed; }
+    uint8_t size() const { return _count; }
+    float cardsPerMinute();
+    String statusJson();
+
+private:
+    void lock();
+    void unlock();
+    bool claimed(int index, uint16_t generation) const; // caller holds the lock
+    float rate() const;                                 // caller holds the lock
+
+    ProvisionJob _jobs[PROVISION_QUEUE_SIZE];
+    uint8_t _count;
+    uint8_t _written;
+    uint8_t _failed;
+    unsigned long _firstWriteAt;
+    unsigned long _lastWriteAt;
+    uint16_t _generation; // bumped by clear()
+    SemaphoreHandle_t _mutex;
+};
+
+extern ProvisionQueue provisionQueue;
+
+#endif // PROVISIONING_H
@@ -3,50 +3,22 @@
 #define RFIDDATA_H
 
 #include <Arduino.h>
-#include <MFRC522.h>
+#include "ProfileCodec.h"
 
-// Struct to hold RFID data
-struct RFIDData
-{
-    String name;      // 6 characters max
-    int age;          // 00-99
-    int coins;        // 00-99
-    int creatureType; // 00-34 (0 reserved for 'no creature')
-    uint8_t bools;    // 0-15 representing 4 boolean values
-};
-
-// Add RFIDParsed struct BEFORE references to parseRawRFID
-struct RFIDParsed
-{
-    int age;
-    int coins;
-    int creatureType;
-    int boolVal;
-    String name;
-};
+#define PROFILE_BLOCK 1 // Card block holding the profile record (see ProfileCodec.h)
 
+// A card profile as the game sees it. The coin balance lives in the value
+// block once migrated and can outgrow the profile's coins field.
 struct Creature
 {
-    int trainerAge;
-    int coins;
-    int creatureType;
-    String customName;
-    int intVal; // Ensure this member exists if needed
-    // String userId;
+    ProfileFields profile;
+    int32_t coins;
+    bool coinsOnCard; // coins were read from a value block, so awards can go on the card
 };
-extern RFIDData pendingData;
+extern ProfileFields pendingData;
 extern bool dataPending;
 
 uint8_t encodeBools(bool A, bool B, bool C, bool D);
-void decodeBools(uint8_t bools, bool &A, bool &B, bool &C, bool &D);
-String readFromRFID(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key, byte blockAddr);
-String readFromRFID(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key, byte blockAddr, int &intPart, String &strPart);
-bool writeToRFID(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key, const String &data, byte blockAddr);
-bool writeRFIDData(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key, const RFIDData &data);
-void parseRFIDData(const String &data, RFIDData &rfidData);
-RFIDParsed parseRawRFID(const String &raw);
-
-// Add decode(...) prototype here:
-Creature decode(int numericPart, const String &namePart);
+Creature decode(const ProfileFields &fields);
 
 #endif // RFIDDATA_H
\ No newline at end of file
@@ -0,0 +1,412 @@
+#include "RFIDSession.h"
+
+RFIDSession::RFIDSession(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key)
+    : _mfrc522(mfrc522), _key(key), _openSector(-1),
+      _authCount(0), _readCount(0), _writeCount(0), _skipCount(0), _shadowNext(0), _tuner(nullptr),
+      _onCardWritten(nullptr)
+{
+    for (byte i = 0; i < SESSION_SHADOW_BLOCKS; i++)
+    {
+        _shadow[i].valid = false;
+    }
+
+    // Default key for MIFARE cards (0xFF)
+    for (byte i = 0; i < 6; i++)
+    {
+        _key.keyByte[i] = 0xFF;
+    }
+}
+
+RFIDSession::~RFIDSession()
+{
+    end();
+}
+
+bool RFIDSession::isUltralight() const
+{
+    return MFRC522::PICC_GetType(_mfrc522.uid.sak) == MFRC522::PICC_TYPE_MIFARE_UL;
+}
+
+bool RFIDSession::authenticate(byte blockAddr)
+{
+    if (isUltralight())
+    {
+        return true; // No Crypto1 on Ultralight/NTAG
+    }
+
+    int sector = blockAddr / 4;
+    if (sector == _openSector)
+    {
+        return true; // Already authenticated for this sector
+    }
+
+    byte trailerBlock = sector * 4 + 3; // Trailer block for the sector
+
+    Serial.print("[RFIDSession] Authenticating sector ");
+    Serial.println(sector);
+
+    _authCount++;
+    MFRC522::StatusCode status = _mfrc522.PCD_Authenticate(
+        MFRC522::PICC_CMD_MF_AUTH_KEY_A,
+        trailerBlock,
+        &_key,
+        &(_mfrc522.uid));
+    track(RFOp::Auth, status);
+
+    if (status != MFRC522::STATUS_OK)
+    {
+        Serial.print("Authentication failed: ");
+        Serial.println(_mfrc522.GetStatusCodeName(status));
+        end();
+        return false;
+    }
+
+    _openSector = sector;
+    return true;
+}
+
+bool RFIDSession::readBlock(byte blockAddr, byte *buffer)
+{
+    if (!authenticate(blockAddr))
+    {
+        return false;
+    }
+
+    // MIFARE_Read needs room for the 2 CRC bytes
+    byte readBuffer[18];
+    byte size = sizeof(readBuffer);
+    _readCount++;
+    byte readAddr = isUltralight() ? blockAddr * 4 : blockAddr; // Ultralight READ returns 4 pages
+    MFRC522::StatusCode status = _mfrc522.MIFARE_Read(readAddr, readBuffer, &size);
+    track(RFOp::Read, status);
+    if (status != MFRC522::STATUS_OK)
+    {
+        Serial.print("Read failed: ");
+        Serial.println(_mfrc522.GetStatusCodeName(status));
+        end();
+        return false;
+    }
+
+    memcpy(buffer, readBuffer, 16);
+    rememberBlock(blockAddr, buffer);
+    return true;
+}
+
+bool RFIDSession::writeBlock(byte blockAddr, const byte *buffer)
+{
+    if (!authenticate(blockAddr))
+    {
+        return false;
+    }
+
+    if (isUltralight())
+    {
+        if (!writeUltralightBlock(blockAddr, buffer))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        byte dataBlock[16];
+        memcpy(dataBlock, buffer, 16);
+        _writeCount++;
+        MFRC522::StatusCode status = _mfrc522.MIFARE_Write(blockAddr, dataBlock, 16);
+        track(RFOp::Write, status);
+        if (status != MFRC522::STATUS_OK)
+        {
+            Serial.print("Write failed: ");
+            Serial.println(_mfrc522.GetStatusCodeName(status));
+            end();
+            return false;
+        }
+    }
+
+    rememberBlock(blockAddr, buffer);
+    cardWritten();
+    return true;
+}
+
+// Ultralight writes are one page (4 bytes) at a time, so pages the shadow
+// says are unchanged are skipped
+bool RFIDSession::writeUltralightBlock(byte blockAddr, const byte *buffer)
+{
+    ShadowBlock *shadow = findShadow(blockAddr);
+    _writeCount++;
+    for (byte page = 0; page < 4; page++)
+    {
+        const byte *pageData = buffer + page * 4;
+        if (shadow && memcmp(shadow->data + page * 4, pageData, 4) == 0)
+        {
+            continue;
+        }
+
+        byte pageBuffer[4];
+        memcpy(pageBuffer, pageData, 4);
+        MFRC522::StatusCode status = _mfrc522.MIFARE_Ultralight_Write(blockAddr * 4 + page, pageBuffer, 4);
+        track(RFOp::Write, status);
+        if (status != MFRC522::STATUS_OK)
+        {
+            Serial.print("Page write failed: ");
+            Serial.println(_mfrc522.GetStatusCodeName(status));
+            forgetBlock(blockAddr); // some pages may have been written
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RFIDSession::writeBlockIfChanged(byte blockAddr, const byte *buffer)
+{
+    ShadowBlock *shadow = findShadow(blockAddr);
+    if (shadow && memcmp(shadow->data, buffer, 16) == 0)
+    {
+        _skipCount++;
+        return true; // Card already holds these bytes
+    }
+    return writeBlock(blockAddr, buffer);
+}
+
+bool RFIDSession::commit(const BlockImage *blocks, uint8_t count)
+{
+    if (count > 64)
+    {
+        Serial.println("[RFIDSession] Commit too large");
+        return false;
+    }
+
+    // Visit the blocks sector by sector so each sector is authenticated once
+    uint16_t writesBefore = _writeCount;
+    uint16_t skipsBefore = _skipCount;
+    uint64_t done = 0;
+    for (uint8_t visited = 0; visited < count; visited++)
+    {
+        // Prefer the open sector, otherwise the lowest remaining one
+        int next = -1;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (done & (1ULL << i))
+            {
+                continue;
+            }
+            if (blocks[i].blockAddr / 4 == _openSector)
+            {
+                next = i;
+                break;
+            }
+            if (next == -1 || blocks[i].blockAddr < blocks[next].blockAddr)
+            {
+                next = i;
+            }
+        }
+
+        done |= 1ULL << next;
+        if (!writeBlockIfChanged(blocks[next].blockAddr, blocks[next].data))
+        {
+            return false;
+        }
+    }
+
+    Serial.print("[RFIDSession] Commit: written ");
+    Serial.print(_writeCount - writesBefore);
+    Serial.print(", skipped ");
+    Serial.println(_skipCount - skipsBefore);
+    return true;
+}
+
+bool RFIDSession::readValue(byte blockAddr, int32_t &value)
+{
+    if (isUltralight())
+    {
+        byte block[16];
+        return readBlock(blockAddr, block) && decodeValueBlock(block, value);
+    }
+
+    if (!authenticate(blockAddr))
+    {
+        return false;
+    }
+
+    _readCount++;
+    MFRC522::StatusCode status = _mfrc522.MIFARE_GetValue(blockAddr, &value);
+    track(RFOp::Read, status);
+    if (status != MFRC522::STATUS_OK)
+    {
+        Serial.print("Value read failed: ");
+        Serial.println(_mfrc522.GetStatusCodeName(status));
+        end();
+        return false;
+    }
+    return true;
+}
+
+bool RFIDSession::writeValue(byte blockAddr, int32_t value)
+{
+    if (isUltralight())
+    {
+        byte block[16];
+        encodeValueBlock(value, blockAddr, block);
+        return writeBlock(blockAddr, block);
+    }
+
+    if (!authenticate(blockAddr))
+    {
+        return false;
+    }
+
+    _writeCount++;
+    MFRC522::StatusCode status = _mfrc522.MIFARE_SetValue(blockAddr, value);
+    track(RFOp::Write, status);
+    if (status != MFRC522::STATUS_OK)
+    {
+        Serial.print("Value write failed: ");
+        Serial.println(_mfrc522.GetStatusCodeName(status));
+        end();
+        return false;
+    }
+
+    forgetBlock(blockAddr);
+    cardWritten();
+    return true;
+}
+
+bool RFIDSession::addValue(byte blockAddr, int32_t delta)
+{
+    if (isUltralight())
+    {
+        // Not atomic like increment + transfer: a card pulled mid-write can tear the block
+        int32_t value;
+        return readValue(blockAddr, value) && writeValue(blockAddr, value + delta);
+    }
+
+    if (!authenticate(blockAddr))
+    {
+        return false;
+    }
+
+    // Increment/decrement land in the card's internal register; transfer commits them
+    _writeCount++;
+    MFRC522::StatusCode status = (delta >= 0)
+                                     ? _mfrc522.MIFARE_Increment(blockAddr, delta)
+                                     : _mfrc522.MIFARE_Decrement(blockAddr, -delta);
+    if (status == MFRC522::STATUS_OK)
+    {
+        status = _mfrc522.MIFARE_Transfer(blockAddr);
+    }
+    track(RFOp::Write, status);
+    if (status != MFRC522::STATUS_OK)
+    {
+        Serial.print("Value update failed: ");
+        Serial.println(_mfrc522.GetStatusCodeName(status));
+        end();
+        return false;
+    }
+
+    forgetBlock(blockAddr);
+    cardWritten();
+    return true;
+}
+
+bool RFIDSession::reselect()
+{
+    // Wake the card (it may be HALTed or back in IDLE) and select it by its known UID
+    end();
+    byte atqa[2];
+    byte atqaSize = sizeof(atqa);
+    return _mfrc522.PICC_WakeupA(atqa, &atqaSize) == MFRC522::STATUS_OK &&
+           _mfrc522.PICC_Select(&_mfrc522.uid, _mfrc522.uid.size * 8) == MFRC522::STATUS_OK;
+}
+
+void RFIDSession::end()
+{
+    _mfrc522.PCD_StopCrypto1(); // Stop encryption on PCD
+    _openSector = -1;
+}
+
+void RFIDSession::track(RFOp op, MFRC522::StatusCode status)
+{
+    if (_tuner)
+    {
+        _tuner->record(op, status);
+    }
+}
+
+void RFIDSession::newTap()
+{
+    _authCount = 0;
+    _readCount = 0;
+    _writeCount = 0;
+    _skipCount = 0;
+    for (byte i = 0; i < SESSION_SHADOW_BLOCKS; i++)
+    {
+        _shadow[i].valid = false;
+    }
+}
+
+RFIDSession::ShadowBlock *RFIDSession::findShadow(byte blockAddr)
+{
+    for (byte i = 0; i < SESSION_SHADOW_BLOCKS; i++)
+    {
+        if (_shadow[i].valid && _shadow[i].blockAddr == blockAddr)
+        {
+            return &_shadow[i];
+        }
+    }
+    return nullptr;
+}
+
+void RFIDSession::rememberBlock(byte blockAddr, const byte *data)
+{
+    ShadowBlock *shadow = findShadow(blockAddr);
+    if (!shadow)
+    {
+        shadow = &_shadow[_shadowNext];
+        _shadowNext = (_shadowNext + 1) % SESSION_SHADOW_BLOCKS;
+    }
+    shadow->blockAddr = blockAddr;
+    memcpy(shadow->data, data, 16);
+    shadow->valid = true;
+}
+
+void RFIDSession::forgetBlock(byte blockAddr)
+{
+    ShadowBlock *shadow = findShadow(blockAddr);
+    if (shadow)
+    {
+        shadow->valid = false;
+    }
+}
+
+// The card changed, so any cached copy of it is stale
+void RFIDSession::cardWritten()
+{
+    if (_onCardWritten)
+    {
+        _onCardWritten(_mfrc522.uid);
+    }
+}
+
+void encodeValueBlock(int32_t value, byte blockAddr, byte *block)
+{
+    // Same layout MIFARE_SetValue writes
+    for (byte i = 0; i < 4; i++)
+    {
+        block[i] = block[i + 8] = (value >> (8 * i)) & 0xFF;
+        block[i + 4] = ~block[i];
+    }
+    block[12] = block[14] = blockAddr;
+    block[13] = block[15] = ~blockAddr;
+}
+
+bool decodeValueBlock(const byte *block, int32_t &value)
+{
+    for (byte i = 0; i < 4; i++)
+    {
+        if (block[i] != (byte)~block[i + 4] || block[i] != block[i + 8])
+        {
+            return false;
+        }
+    }
+    value = (int32_t(block[3]) << 24) | (int32_t(block[2]) << 16) | (int32_t(block[1]) << 8) | int32_t(block[0]);
+    return true;
+}
@@ -0,0 +1,99 @@
+// RFIDSession.h
+#ifndef RFIDSESSION_H
+#define RFIDSESSION_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFTuner.h"
+
+#define SESSION_SHADOW_BLOCKS 8 // Blocks remembered per tap for diff writes
+
+// Raw value block layout, as MIFARE_SetValue writes it
+void encodeValueBlock(int32_t value, byte blockAddr, byte *block);
+
+// Decode a raw value block read with MIFARE_Read; false if the block is not
+// in value format (value / inverted value / value copies disagree)
+bool decodeValueBlock(const byte *block, int32_t &value);
+
+// Called after a write changed the card, e.g. to drop cached copies of it
+typedef void (*CardWrittenCallback)(const MFRC522::Uid &uid);
+
+// One block of a card image to commit
+struct BlockImage
+{
+    byte blockAddr;
+    byte data[16];
+};
+
+// Keeps one MIFARE Classic sector authenticated for the length of a tap.
+// Reads and writes to blocks in the open sector reuse the same Crypto1
+// session; touching a block in another sector re-authenticates once.
+//
+// MIFARE Ultralight / NTAG cards (picked by PICC_GetType(uid.sak)) need no
+// auth: block N is stored on pages 4N..4N+3, read with one 4-page READ and
+// written page by page. Value blocks are kept in the same 16-byte layout
+// and updated read-modify-write, since these cards have no value commands.
+class RFIDSession
+{
+public:
+    RFIDSession(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key);
+    ~RFIDSession();
+
+    bool authenticate(byte blockAddr);                   // no-op if the sector is already open
+    bool readBlock(byte blockAddr, byte *buffer);        // buffer must hold 16 bytes
+    bool writeBlock(byte blockAddr, const byte *buffer); // writes 16 bytes
+
+    // Diff writes against the shadow of blocks read/written during this tap.
+    // Blocks the tap has not seen are always written.
+    bool writeBlockIfChanged(byte blockAddr, const byte *buffer);
+    bool commit(const BlockImage *blocks, uint8_t count); // sector by sector, one auth each
+
+    // MIFARE Classic value blocks (block must be formatted as a value block)
+    bool readValue(byte blockAddr, int32_t &value);
+    bool writeValue(byte blockAddr, int32_t value);     // formats the block as a value block
+    bool addValue(byte blockAddr, int32_t delta);       // increment/decrement + transfer
+
+    void setTuner(RFTuner *tuner) { _tuner = tuner; } // gets every auth/read/write status
+    void setOnCardWritten(CardWrittenCallback callback) { _onCardWritten = callback; }
+
+    bool isUltralight() const; // card currently selected is Ultralight/NTAG
+    bool reselect();           // WUPA + select by the known UID, e.g. after a failed auth
+
+    void end();                                          // drop auth, keep card selected
+    void newTap();                                       // clear shadow and per-tap counters
+
+    int openSector() const { return _openSector; }
+    uint16_t authCount() const { return _authCount; }
+    uint16_t readCount() const { return _readCount; }
+    uint16_t writeCount() const { return _writeCount; }
+    uint16_t blocksSkipped() const { return _skipCount; } // unchanged blocks not rewritten
+
+private:
+    struct ShadowBlock
+    {
+        byte blockAddr;
+        byte data[16];
+        bool valid;
+    };
+
+    ShadowBlock *findShadow(byte blockAddr);
+    void rememberBlock(byte blockAddr, const byte *data);
+    void forgetBlock(byte blockAddr);
+    bool writeUltralightBlock(byte blockAddr, const byte *buffer);
+    void track(RFOp op, MFRC522::StatusCode status);
+    void cardWritten();
+
+    MFRC522 &_mfrc522;
+    MFRC522::MIFARE_Key &_key;
+    int _openSector;
+    uint16_t _authCount;
+    uint16_t _readCount;
+    uint16_t _writeCount;
+    uint16_t _skipCount;
+    ShadowBlock _shadow[SESSION_SHADOW_BLOCKS];
+    byte _shadowNext; // round-robin slot when the shadow is full
+    RFTuner *_tuner;
+    CardWrittenCallback _onCardWritten;
+};
+
+#endif // RFIDSESSION_H
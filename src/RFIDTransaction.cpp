@@ -0,0 +1,173 @@
+#include "RFIDTransaction.h"
+#include "CardDetect.h"
+#include "GlobalDefs.h"
+
+RFIDTransaction::RFIDTransaction(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key)
+    : _mfrc522(mfrc522), _session(mfrc522, key), _state(RFIDTxState::Idle),
+      _retryState(RFIDTxState::Idle), _failure(RFIDTxFailure::None), _isWrite(false), _count(0), _index(0),
+      _stepStart(0), _maxPollUs(0), _retries(0), _retryLimit(RF_TUNE_DEFAULT_RETRIES)
+{
+    memset(_blockAddrs, 0, sizeof(_blockAddrs));
+    memset(_data, 0, sizeof(_data));
+}
+
+void RFIDTransaction::beginRead(byte blockAddr, bool waitForCard)
+{
+    begin(&blockAddr, 1, false, waitForCard);
+}
+
+void RFIDTransaction::beginRead(const byte *blockAddrs, uint8_t count, bool waitForCard)
+{
+    begin(blockAddrs, count, false, waitForCard);
+}
+
+void RFIDTransaction::beginWrite(byte blockAddr, const byte *data, bool waitForCard)
+{
+    memcpy(_data[0], data, sizeof(_data[0]));
+    begin(&blockAddr, 1, true, waitForCard);
+}
+
+void RFIDTransaction::begin(const byte *blockAddrs, uint8_t count, bool isWrite, bool waitForCard)
+{
+    _count = min<uint8_t>(count, TX_MAX_BLOCKS);
+    memcpy(_blockAddrs, blockAddrs, _count);
+    _index = 0;
+    _isWrite = isWrite;
+    _failure = RFIDTxFailure::None;
+    if (waitForCard)
+    {
+        // New tap: fresh auth and per-tap counters
+        _session.end();
+        _session.newTap();
+        enter(RFIDTxState::WaitCard);
+    }
+    else
+    {
+        enter(RFIDTxState::Authenticate);
+    }
+}
+
+void RFIDTransaction::reset()
+{
+    _failure = RFIDTxFailure::None;
+    _session.end();
+    enter(RFIDTxState::Idle);
+}
+
+void RFIDTransaction::enter(RFIDTxState state, bool restartTimer)
+{
+    _state = state;
+    if (restartTimer)
+    {
+        _retries = 0;
+        _stepStart = millis();
+    }
+}
+
+RFIDTxResult RFIDTransaction::poll()
+{
+    unsigned long callStart = micros();
+    RFIDTxResult result = step();
+    uint32_t spent = micros() - callStart;
+    if (spent > _maxPollUs)
+    {
+        _maxPollUs = spent;
+    }
+    return result;
+}
+
+// Retry a failed step through a reselect, within the retry budget (and RFID_STEP_TIMEOUT_MS)
+RFIDTxResult RFIDTransaction::retry(RFIDTxState state)
+{
+    if (++_retries > _retryLimit)
+    {
+        Serial.println("[RFIDTransaction] Out of retries");
+        _failure = RFIDTxFailure::OutOfRetries;
+        _session.end();
+        enter(RFIDTxState::Failed);
+        return RFIDTxResult::Failed;
+    }
+    _retryState = state;
+    enter(RFIDTxState::Reselect, false);
+    return RFIDTxResult::InProgress;
+}
+
+RFIDTxResult RFIDTransaction::step()
+{
+    switch (_state)
+    {
+    case RFIDTxState::Idle:
+        return RFIDTxResult::Idle;
+
+    case RFIDTxState::WaitCard:
+        if (cardDetectPoll(_mfrc522))
+        {
+            enter(RFIDTxState::Authenticate);
+        }
+        else if (RFID_CARD_WAIT_TIMEOUT_MS > 0 && millis() - _stepStart >= RFID_CARD_WAIT_TIMEOUT_MS)
+        {
+            Serial.println("[RFIDTransaction] No card presented");
+            _failure = RFIDTxFailure::NoCard;
+            enter(RFIDTxState::Failed);
+            return RFIDTxResult::Failed;
+        }
+        return RFIDTxResult::InProgress;
+
+    case RFIDTxState::Authenticate:
+        if (_session.authenticate(_blockAddrs[_index]))
+        {
+            // Same step budget: a card that authenticates but never reads still runs out of retries
+            enter(_isWrite ? RFIDTxState::Write : RFIDTxState::Read, false);
+        }
+        else
+        {
+            return retry(RFIDTxState::Authenticate);
+        }
+        return RFIDTxResult::InProgress;
+
+    case RFIDTxState::Read:
+    case RFIDTxState::Write:
+    {
+        bool ok = (_state == RFIDTxState::Read)
+                      ? _session.readBlock(_blockAddrs[_index], _data[_index])
+                      : _session.writeBlockIfChanged(_blockAddrs[_index], _data[_index]);
+        if (ok && ++_index < _count)
+        {
+            enter(RFIDTxState::Authenticate); // no-op auth if the next block shares the sector
+            return RFIDTxResult::InProgress;
+        }
+        if (ok)
+        {
+            enter(RFIDTxState::Done);
+            return RFIDTxResult::Done;
+        }
+        // A failed read/write drops Crypto1, so the card needs a fresh auth
+        return retry(RFIDTxState::Authenticate);
+    }
+
+    case RFIDTxState::Reselect:
+    {
+        if (millis() - _stepStart >= RFID_STEP_TIMEOUT_MS)
+        {
+            Serial.println("[RFIDTransaction] Step timed out");
+            _failure = RFIDTxFailure::CardLost;
+            _session.end();
+            enter(RFIDTxState::Failed);
+            return RFIDTxResult::Failed;
+        }
+
+        if (_session.reselect())
+        {
+            enter(_retryState, false);
+        }
+        return RFIDTxResult::InProgress;
+    }
+
+    case RFIDTxState::Done:
+        return RFIDTxResult::Done;
+
+    case RFIDTxState::Failed:
+    default:
+        return RFIDTxResult::Failed;
+    }
+}
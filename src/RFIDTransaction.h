@@ -0,0 +1,89 @@
+// RFIDTransaction.h
+#ifndef RFIDTRANSACTION_H
+#define RFIDTRANSACTION_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFIDSession.h"
+
+#define TX_MAX_BLOCKS 4 // Most blocks one read transaction can pull
+
+enum class RFIDTxState : uint8_t
+{
+    Idle,
+    WaitCard,     // waiting for a card to be presented
+    Authenticate, // sector auth for the target block
+    Read,
+    Write,
+    Reselect, // WUPA + select after a failed step, then retry
+    Done,
+    Failed
+};
+
+enum class RFIDTxResult : uint8_t
+{
+    Idle,
+    InProgress,
+    Done,
+    Failed
+};
+
+// Why a transaction ended in Failed
+enum class RFIDTxFailure : uint8_t
+{
+    None,
+    NoCard,      // no card presented within RFID_CARD_WAIT_TIMEOUT_MS
+    CardLost,    // the card stopped answering the reselect, e.g. lifted mid-tap
+    OutOfRetries // the card answered but a step kept failing
+};
+
+// Resumable card read/write. Each poll() does at most one reader operation
+// (one REQA, auth, read or write frame) so loop() never blocks on the card.
+// Auth/read/write retry through a reselect, up to the retry limit and
+// RFID_STEP_TIMEOUT_MS.
+class RFIDTransaction
+{
+public:
+    RFIDTransaction(MFRC522 &mfrc522, MFRC522::MIFARE_Key &key);
+
+    // waitForCard: detect and select a new card first, otherwise use the card
+    // that is already selected (e.g. write back after a read in the same tap)
+    void beginRead(byte blockAddr, bool waitForCard = true);
+    void beginRead(const byte *blockAddrs, uint8_t count, bool waitForCard = true); // one block per poll()
+    void beginWrite(byte blockAddr, const byte *data, bool waitForCard = false);
+    RFIDTxResult poll();
+    void reset(); // abort and drop the sector auth
+
+    RFIDTxState state() const { return _state; }
+    RFIDTxFailure failure() const { return _failure; }
+    bool isWrite() const { return _isWrite; }
+    uint8_t blockCount() const { return _count; }
+    byte blockAddr(uint8_t index = 0) const { return _blockAddrs[index]; }
+    const byte *data(uint8_t index = 0) const { return _data[index]; } // block read (or written)
+    RFIDSession &session() { return _session; }
+    uint32_t maxPollUs() const { return _maxPollUs; } // longest single poll() so far
+    void setRetryLimit(uint8_t retries) { _retryLimit = retries; } // per step, set by RFTuner
+
+private:
+    void begin(const byte *blockAddrs, uint8_t count, bool isWrite, bool waitForCard);
+    void enter(RFIDTxState state, bool restartTimer = true);
+    RFIDTxResult step();
+    RFIDTxResult retry(RFIDTxState state);
+
+    MFRC522 &_mfrc522;
+    RFIDSession _session;
+    RFIDTxState _state;
+    RFIDTxState _retryState; // step to go back to after a reselect
+    RFIDTxFailure _failure;
+    bool _isWrite;
+    byte _blockAddrs[TX_MAX_BLOCKS];
+    byte _data[TX_MAX_BLOCKS][16];
+    uint8_t _count;
+    uint8_t _index; // block currently being read/written
+    unsigned long _stepStart;
+    uint32_t _maxPollUs;
+    uint8_t _retries; // failed attempts at the current step
+    uint8_t _retryLimit;
+};
+
+#endif // RFIDTRANSACTION_H
@@ -0,0 +1,190 @@
+#include "RFTuner.h"
+#include "RFIDTransaction.h"
+#include <Preferences.h>
+
+#define RATE_UNKNOWN 255
+
+// Gain steps the tuner may use. 18 dB is left out: too weak for cards
+// through an enclosure lid.
+static const byte gainMasks[RF_TUNE_GAIN_LEVELS] = {
+    MFRC522::RxGain_23dB, MFRC522::RxGain_33dB, MFRC522::RxGain_38dB,
+    MFRC522::RxGain_43dB, MFRC522::RxGain_48dB};
+static const uint8_t gainDbs[RF_TUNE_GAIN_LEVELS] = {23, 33, 38, 43, 48};
+
+RFTuner::RFTuner(MFRC522 &mfrc522, RFIDTransaction &tx)
+    : _mfrc522(mfrc522), _tx(tx), _reader(0), _windowOps(0), _windowErrors(0),
+      _gainIndex(RF_TUNE_DEFAULT_GAIN), _retries(RF_TUNE_DEFAULT_RETRIES), _adjustments(0), _dirty(false)
+{
+    memset(_ops, 0, sizeof(_ops));
+    memset(_levelRate, RATE_UNKNOWN, sizeof(_levelRate));
+}
+
+void RFTuner::begin(uint8_t readerIndex)
+{
+    _reader = readerIndex;
+
+    Preferences prefs;
+    prefs.begin("rftune", true);
+    _gainIndex = prefs.getUChar(("gain" + String(_reader)).c_str(), RF_TUNE_DEFAULT_GAIN);
+    _retries = prefs.getUChar(("retry" + String(_reader)).c_str(), RF_TUNE_DEFAULT_RETRIES);
+    prefs.end();
+
+    // Stored values from an older build may be out of range
+    if (_gainIndex >= RF_TUNE_GAIN_LEVELS)
+    {
+        _gainIndex = RF_TUNE_DEFAULT_GAIN;
+    }
+    _retries = constrain(_retries, RF_TUNE_MIN_RETRIES, RF_TUNE_MAX_RETRIES);
+
+    apply();
+    Serial.println("[RFTuner] Reader " + String(_reader) + ": " + String(gainDb()) + " dB, " + String(_retries) + " retries");
+}
+
+void RFTuner::apply()
+{
+    _mfrc522.PCD_SetAntennaGain(gainMasks[_gainIndex]);
+    _tx.setRetryLimit(_retries);
+}
+
+uint8_t RFTuner::gainDb() const
+{
+    return gainDbs[_gainIndex];
+}
+
+void RFTuner::record(RFOp op, MFRC522::StatusCode status)
+{
+    OpStats &stats = _ops[(uint8_t)op];
+    stats.attempts++;
+    _windowOps++;
+
+    // Only RF-level failures; NAKs and bad arguments say nothing about the field
+    bool rfError = status == MFRC522::STATUS_TIMEOUT || status == MFRC522::STATUS_CRC_WRONG ||
+                   status == MFRC522::STATUS_COLLISION || status == MFRC522::STATUS_ERROR;
+    if (rfError)
+    {
+        stats.errors++;
+        _windowErrors++;
+        if (status == MFRC522::STATUS_TIMEOUT)
+        {
+            stats.timeouts++;
+        }
+        else if (status == MFRC522::STATUS_CRC_WRONG)
+        {
+            stats.crcErrors++;
+        }
+    }
+
+    if (_windowOps >= RF_TUNE_WINDOW)
+    {
+        evaluate();
+    }
+}
+
+void RFTuner::evaluate()
+{
+    uint8_t rate = _windowErrors * 100 / _windowOps;
+    _windowOps = _windowErrors = 0;
+    _levelRate[_gainIndex] = rate;
+
+    uint8_t gainIndex = _gainIndex;
+    uint8_t retries = _retries;
+    if (rate > RF_TUNE_ERROR_HIGH)
+    {
+        // Try an untried neighbour first (higher gain before lower), else
+        // move to a neighbour that did better last time
+        int best = _gainIndex;
+        uint8_t bestRate = rate;
+        int candidates[2] = {_gainIndex + 1, _gainIndex - 1};
+        for (int candidate : candidates)
+        {
+            if (candidate < 0 || candidate >= RF_TUNE_GAIN_LEVELS)
+            {
+                continue;
+            }
+            if (_levelRate[candidate] == RATE_UNKNOWN)
+            {
+                best = candidate;
+                break;
+            }
+            if (_levelRate[candidate] < bestRate)
+            {
+                best = candidate;
+                bestRate = _levelRate[candidate];
+            }
+        }
+
+        if (best != _gainIndex)
+        {
+            gainIndex = best;
+        }
+        else if (_retries < RF_TUNE_MAX_RETRIES)
+        {
+            retries++; // Gain is as good as it gets here, ride out the errors instead
+        }
+    }
+    else if (rate <= RF_TUNE_ERROR_LOW && _retries > RF_TUNE_DEFAULT_RETRIES)
+    {
+        retries--;
+    }
+
+    if (gainIndex == _gainIndex && retries == _retries)
+    {
+        return;
+    }
+
+    Serial.print("[RFTuner] Reader ");
+    Serial.print(_reader);
+    Serial.print(" error rate ");
+    Serial.print(rate);
+    Serial.print("%: gain ");
+    Serial.print(gainDbs[gainIndex]);
+    Serial.print(" dB, retries ");
+    Serial.println(retries);
+
+    _gainIndex = gainIndex;
+    _retries = retries;
+    _adjustments++;
+    apply();
+    _dirty = true; // the NVS write would stall the tap in progress
+}
+
+void RFTuner::poll(bool idle)
+{
+    if (idle && _dirty)
+    {
+        save();
+        _dirty = false;
+    }
+}
+
+// Only called on a change, so flash wear stays low
+void RFTuner::save()
+{
+    Preferences prefs;
+    prefs.begin("rftune", false);
+    prefs.putUChar(("gain" + String(_reader)).c_str(), _gainIndex);
+    prefs.putUChar(("retry" + String(_reader)).c_str(), _retries);
+    prefs.end();
+}
+
+String RFTuner::statsJson() const
+{
+    static const char *opNames[(uint8_t)RFOp::Count] = {"auth", "read", "write"};
+
+    String json = "{";
+    json += "\"gainDb\":" + String(gainDb()) + ",";
+    json += "\"retries\":" + String(_retries) + ",";
+    json += "\"adjustments\":" + String(_adjustments) + ",";
+    for (uint8_t i = 0; i < (uint8_t)RFOp::Count; i++)
+    {
+        const OpStats &stats = _ops[i];
+        json += "\"" + String(opNames[i]) + "\":{";
+        json += "\"attempts\":" + String(stats.attempts) + ",";
+        json += "\"errors\":" + String(stats.errors) + ",";
+        json += "\"timeouts\":" + String(stats.timeouts) + ",";
+        json += "\"crcErrors\":" + String(stats.crcErrors) + "}";
+        json += (i + 1 < (uint8_t)RFOp::Count) ? "," : "";
+    }
+    json += "}";
+    return json;
+}
@@ -0,0 +1,74 @@
+// RFTuner.h
+#ifndef RFTUNER_H
+#define RFTUNER_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+
+class RFIDTransaction;
+
+#define RF_TUNE_WINDOW 40         // Card operations per evaluation
+#define RF_TUNE_ERROR_HIGH 5      // Error % in a window that triggers a change
+#define RF_TUNE_ERROR_LOW 1       // Error % under which extra retries are trimmed
+#define RF_TUNE_MIN_RETRIES 2     // Retry budget per transaction step
+#define RF_TUNE_MAX_RETRIES 8
+#define RF_TUNE_DEFAULT_RETRIES 4
+#define RF_TUNE_GAIN_LEVELS 5     // 23, 33 (default), 38, 43, 48 dB
+#define RF_TUNE_DEFAULT_GAIN 1
+
+enum class RFOp : uint8_t
+{
+    Auth,
+    Read,
+    Write,
+    Count
+};
+
+// Adjusts one reader's receiver gain and retry budget from the error rate of
+// its card operations. Every RF_TUNE_WINDOW operations it looks at the error
+// rate: above RF_TUNE_ERROR_HIGH it steps the gain to an untried or better
+// neighbouring level, or raises the retry budget when no level does better;
+// below RF_TUNE_ERROR_LOW it trims the retries again. The chosen setting is
+// kept in NVS so a station starts from its last good tuning; the write waits
+// for poll() with the pads idle, as record() runs inside a tap.
+class RFTuner
+{
+public:
+    RFTuner(MFRC522 &mfrc522, RFIDTransaction &tx);
+
+    void begin(uint8_t readerIndex); // load from NVS and apply, after PCD_Init()
+    void apply();                    // re-apply, e.g. after the reader was re-initialised
+    void record(RFOp op, MFRC522::StatusCode status);
+    void poll(bool idle); // from loop(): save a changed setting once idle (no card on a pad)
+
+    uint8_t gainDb() const;
+    uint8_t retries() const { return _retries; }
+    uint32_t adjustments() const { return _adjustments; }
+    String statsJson() const;
+
+private:
+    struct OpStats
+    {
+        uint32_t attempts;
+        uint32_t errors;
+        uint32_t timeouts;
+        uint32_t crcErrors;
+    };
+
+    void evaluate();
+    void save();
+
+    MFRC522 &_mfrc522;
+    RFIDTransaction &_tx;
+    uint8_t _reader;
+    OpStats _ops[(uint8_t)RFOp::Count];
+    uint16_t _windowOps;
+    uint16_t _windowErrors;
+    uint8_t _gainIndex;
+    uint8_t _retries;
+    uint8_t _levelRate[RF_TUNE_GAIN_LEVELS]; // last error % seen per level, 255 = untried
+    uint32_t _adjustments;
+    bool _dirty; // setting changed since the last save
+};
+
+#endif // RFTUNER_H
@@ -0,0 +1,119 @@
+#include "ReaderHealth.h"
+#include "CardDetect.h"
+
+ReaderHealth::ReaderHealth(MFRC522 &mfrc522, RFTuner &tuner)
+    : _mfrc522(mfrc522), _tuner(tuner), _version(0), _consecutiveFailures(0), _lastCheck(0),
+      _incidents(0), _failedRecoveries(0), _lastRecoveryMs(0), _maxRecoveryMs(0),
+      _totalRecoveryMs(0), _lastIncidentAt(0), _lastReason("")
+{
+}
+
+void ReaderHealth::begin()
+{
+    _version = _mfrc522.PCD_ReadRegister(MFRC522::VersionReg);
+    _lastCheck = millis();
+    if (versionLooksStuck(_version))
+    {
+        Serial.println("[ReaderHealth] Reader not answering at start-up");
+    }
+}
+
+bool ReaderHealth::versionLooksStuck(byte version) const
+{
+    // 0x00/0xFF is a dead bus or a chip stuck in reset
+    return version == 0x00 || version == 0xFF ||
+           (!(_version == 0x00 || _version == 0xFF) && version != _version);
+}
+
+bool ReaderHealth::poll()
+{
+    unsigned long now = millis();
+    if (now - _lastCheck < HEALTH_CHECK_MS)
+    {
+        return false;
+    }
+    _lastCheck = now;
+
+    byte version = _mfrc522.PCD_ReadRegister(MFRC522::VersionReg);
+    if (!versionLooksStuck(version))
+    {
+        return false;
+    }
+    Serial.print("[ReaderHealth] VersionReg reads 0x");
+    Serial.println(version, HEX);
+    return recover("version");
+}
+
+void ReaderHealth::reportResult(bool ok)
+{
+    if (ok)
+    {
+        _consecutiveFailures = 0;
+        return;
+    }
+    if (++_consecutiveFailures >= HEALTH_FAIL_LIMIT)
+    {
+        recover("failures");
+    }
+}
+
+bool ReaderHealth::recover(const char *reason)
+{
+    unsigned long start = millis();
+    _incidents++;
+    _lastIncidentAt = start;
+    _lastReason = reason;
+    _consecutiveFailures = 0;
+    Serial.println("[ReaderHealth] Resetting reader (" + String(reason) + ")");
+
+    _mfrc522.PCD_Reset();
+    _mfrc522.PCD_Init(); // same pins as the first init
+
+#if HEALTH_SELF_TEST
+    // The self test leaves the chip unusable until the next init
+    bool selfTestOk = _mfrc522.PCD_PerformSelfTest();
+    _mfrc522.PCD_Init();
+    Serial.println(selfTestOk ? "[ReaderHealth] Self test passed" : "[ReaderHealth] Self test FAILED");
+#endif
+
+    // Init put the gain back to default and dropped any armed card IRQ
+    _tuner.apply();
+    cardDetectDisarm(_mfrc522);
+
+    byte version = _mfrc522.PCD_ReadRegister(MFRC522::VersionReg);
+    bool ok = !versionLooksStuck(version);
+    if (ok && (_version == 0x00 || _version == 0xFF))
+    {
+        _version = version; // Reader was dead at start-up and is alive now
+    }
+    if (!ok)
+    {
+        _failedRecoveries++;
+    }
+
+    _lastRecoveryMs = millis() - start;
+    _totalRecoveryMs += _lastRecoveryMs;
+    _maxRecoveryMs = max(_maxRecoveryMs, _lastRecoveryMs);
+    _lastCheck = millis();
+
+    Serial.print("[ReaderHealth] Recovery ");
+    Serial.print(ok ? "done" : "failed");
+    Serial.print(" in ");
+    Serial.print(_lastRecoveryMs);
+    Serial.println(" ms");
+    return true;
+}
+
+String ReaderHealth::statsJson() const
+{
+    String json = "{";
+    json += "\"version\":" + String(_version) + ",";
+    json += "\"incidents\":" + String(_incidents) + ",";
+    json += "\"failedRecoveries\":" + String(_failedRecoveries) + ",";
+    json += "\"lastReason\":\"" + String(_lastReason) + "\",";
+    json += "\"lastIncidentMsAgo\":" + String(_incidents ? millis() - _lastIncidentAt : 0) + ",";
+    json += "\"lastRecoveryMs\":" + String(_lastRecoveryMs) + ",";
+    json += "\"maxRecoveryMs\":" + String(_maxRecoveryMs) + ",";
+    json += "\"avgRecoveryMs\":" + String(_incidents ? _totalRecoveryMs / _incidents : 0) + "}";
+    return json;
+}
@@ -0,0 +1,56 @@
+// ReaderHealth.h
+#ifndef READERHEALTH_H
+#define READERHEALTH_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFTuner.h"
+
+#define HEALTH_CHECK_MS 5000   // VersionReg probe interval while the pad is idle
+#define HEALTH_FAIL_LIMIT 3    // Consecutive failed transactions before a reset
+#define HEALTH_SELF_TEST 0     // 1 = also run PCD_PerformSelfTest() during recovery
+
+// Watches one reader for a wedged MFRC522 and brings it back in place with
+// PCD_Reset() + PCD_Init() (re-applying the tuned gain), so the web server,
+// display and everything else keep running. Triggered by HEALTH_FAIL_LIMIT
+// transactions failing in a row, or by VersionReg reading back 0x00/0xFF
+// or a different version than at start-up.
+class ReaderHealth
+{
+public:
+    ReaderHealth(MFRC522 &mfrc522, RFTuner &tuner);
+
+    void begin(); // after PCD_Init(): remember the chip version
+
+    // Idle-time probe, at most once per HEALTH_CHECK_MS. True if the reader
+    // was reset, so the caller should restart its transaction.
+    bool poll();
+
+    // Outcome of each transaction that reached the card. Only reader faults
+    // belong here, not a card lifted mid-tap. Resets the reader in place
+    // after HEALTH_FAIL_LIMIT failures in a row.
+    void reportResult(bool ok);
+
+    bool recover(const char *reason);
+
+    uint32_t incidents() const { return _incidents; }
+    String statsJson() const;
+
+private:
+    bool versionLooksStuck(byte version) const;
+
+    MFRC522 &_mfrc522;
+    RFTuner &_tuner;
+    byte _version; // VersionReg at start-up
+    uint8_t _consecutiveFailures;
+    unsigned long _lastCheck;
+    uint32_t _incidents;
+    uint32_t _failedRecoveries;
+    uint32_t _lastRecoveryMs;
+    uint32_t _maxRecoveryMs;
+    uint32_t _totalRecoveryMs;
+    unsigned long _lastIncidentAt;
+    const char *_lastReason;
+};
+
+#endif // READERHEALTH_H
@@ -0,0 +1,55 @@
+#include "ReaderPool.h"
+#include "GlobalDefs.h"
+
+static const byte readerSsPins[READER_COUNT] = READER_SS_PINS;
+static uint8_t turn = 0;
+
+ReaderContext readers[READER_COUNT];
+
+ReaderContext::ReaderContext()
+    : mfrc522(), tx(mfrc522, key), presence(mfrc522), tuner(mfrc522, tx), health(mfrc522, tuner), index(0), tapStart(0),
+      provisionJob(-1), provisionGeneration(0), blankCardWrite(false)
+{
+    tx.session().setTuner(&tuner);
+    memset(provisionBlock, 0, sizeof(provisionBlock));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void readersBegin()
+{
+    // A pad whose SS floats would answer on the shared bus while another is being set up
+    for (uint8_t i = 0; i < READER_COUNT; i++)
+    {
+        pinMode(readerSsPins[i], OUTPUT);
+        digitalWrite(readerSsPins[i], HIGH);
+    }
+
+    for (uint8_t i = 0; i < READER_COUNT; i++)
+    {
+        readers[i].index = i;
+        readers[i].mfrc522.PCD_Init(readerSsPins[i], RST_PIN);
+        readers[i].tuner.begin(i);
+        readers[i].health.begin();
+        Serial.print("[readersBegin] Reader ");
+        Serial.print(i);
+        Serial.print(" on SS ");
+        Serial.print(readerSsPins[i]);
+        Serial.print(", version 0x");
+        Serial.println(readers[i].mfrc522.PCD_ReadRegister(MFRC522::VersionReg), HEX);
+    }
+}
+
+ReaderContext &nextReader()
+{
+    ReaderContext &reader = readers[turn];
+    turn = (turn + 1) % READER_COUNT;
+    reader.stats.steps++;
+    return reader;
+}
+
+void recordTap(ReaderContext &reader, uint32_t tapMs)
+{
+    reader.stats.taps++;
+    reader.stats.totalTapMs += tapMs;
+    reader.stats.maxTapMs = max(reader.stats.maxTapMs, tapMs);
+}
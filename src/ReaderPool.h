@@ -0,0 +1,56 @@
+// ReaderPool.h
+#ifndef READERPOOL_H
+#define READERPOOL_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFIDTransaction.h"
+#include "CardPresence.h"
+#include "RFTuner.h"
+#include "ReaderHealth.h"
+#include "TapBuffer.h"
+#include "GlobalDefs.h"
+
+struct ReaderStats
+{
+    uint32_t steps;   // scheduler turns given to this reader
+    uint32_t taps;    // taps processed to the end
+    uint32_t failed;  // reads/writes that gave up
+    uint32_t totalTapMs;
+    uint32_t maxTapMs;
+};
+
+// One reader pad: its MFRC522, its own transaction (and so its own session,
+// shadow and counters) and the per-tap state main.cpp keeps for it.
+struct ReaderContext
+{
+    ReaderContext();
+
+    MFRC522 mfrc522; // first, so the members below can bind to it
+    RFIDTransaction tx;
+    CardPresence presence;
+    RFTuner tuner; // gain and retry budget for this pad
+    ReaderHealth health;
+    TapBuffer tapBuffer;
+    uint8_t index;
+    unsigned long tapStart;
+    int provisionJob; // queue index being written, -1 when not provisioning
+    uint16_t provisionGeneration; // queue generation the job was claimed in
+    byte provisionBlock[16]; // the job's encoded profile, written once the card reads blank
+    bool blankCardWrite;
+    ReaderStats stats;
+};
+
+extern ReaderContext readers[READER_COUNT];
+
+// Deselect every pad, then init each one on its own SS pin (shared RST)
+void readersBegin();
+
+// Round-robin scheduler: the reader that gets the next turn. Each turn
+// should do at most one short reader operation (one tx.poll()), so a card
+// on one pad never holds up the others for longer than a frame.
+ReaderContext &nextReader();
+
+void recordTap(ReaderContext &reader, uint32_t tapMs);
+
+#endif // READERPOOL_H
@@ -0,0 +1,37 @@
+#include "TapBuffer.h"
+#include "RFIDData.h"
+#include "CoinStore.h"
+
+const byte tapBlocks[TAP_BLOCK_COUNT] = {PROFILE_BLOCK, COIN_VALUE_BLOCK};
+
+const byte *TapBuffer::block(byte blockAddr) const
+{
+    for (byte i = 0; i < TAP_BLOCK_COUNT; i++)
+    {
+        if (tapBlocks[i] == blockAddr)
+        {
+            return blocks[i];
+        }
+    }
+    return nullptr;
+}
+
+byte *TapBuffer::block(byte blockAddr)
+{
+    return const_cast<byte *>(static_cast<const TapBuffer *>(this)->block(blockAddr));
+}
+
+bool readAhead(MFRC522 &mfrc522, RFIDSession &session, TapBuffer &buffer)
+{
+    buffer.uid = mfrc522.uid;
+    buffer.loaded = true;
+    for (byte i = 0; i < TAP_BLOCK_COUNT; i++)
+    {
+        if (!buffer.loaded || !session.readBlock(tapBlocks[i], buffer.blocks[i]))
+        {
+            memset(buffer.blocks[i], 0, sizeof(buffer.blocks[i]));
+            buffer.loaded = false;
+        }
+    }
+    return buffer.loaded;
+}
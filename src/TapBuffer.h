@@ -0,0 +1,28 @@
+// TapBuffer.h
+#ifndef TAPBUFFER_H
+#define TAPBUFFER_H
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "RFIDSession.h"
+
+// Every card block the firmware uses. They are all read right after the card
+// is selected so the rest of the tap works from RAM and the card can be lifted.
+#define TAP_BLOCK_COUNT 2
+extern const byte tapBlocks[TAP_BLOCK_COUNT]; // PROFILE_BLOCK, COIN_VALUE_BLOCK
+
+struct TapBuffer
+{
+    MFRC522::Uid uid;
+    byte blocks[TAP_BLOCK_COUNT][16];
+    bool loaded; // every block in tapBlocks was read
+
+    // nullptr if blockAddr is not one of tapBlocks
+    const byte *block(byte blockAddr) const;
+    byte *block(byte blockAddr);
+};
+
+// Blocking read-ahead of the selected card (group taps read cards back to back)
+bool readAhead(MFRC522 &mfrc522, RFIDSession &session, TapBuffer &buffer);
+
+#endif // TAPBUFFER_H
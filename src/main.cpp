@@ -21,7 +21,24 @@ but i need it to work using the creature name
 #include "RFIDData.h"
 #include "arduino_secrets.h"
 #include "GlobalDefs.h"
-#include <HTTPClient.h>
+#include "CardDetect.h"
+#include "RFIDTransaction.h"
+#include "ProfileCache.h"
+#include "CardScanner.h"
+#include "CoinStore.h"
+#include "TapBuffer.h"
+#include "Provisioning.h"
+#include "CardPresence.h"
+#include "CardImage.h"
+#include "ReaderPool.h"
+#include "ProfileBindings.h"
+#include "CodecBench.h"
+#include "CardMigration.h"
+#include "GameApi.h"
+#include "NameIndex.h"
+#include "ApiBench.h"
+#include "ApiJournal.h"
+#include "NetWorker.h"
 
 // Create the AsyncWebServer on port 80
 AsyncWebServer server(80);
@@ -34,7 +51,6 @@ bool tagDetected = false;
 bool serverRunning = false;
 bool newCreature = false;
 
-RFIDData rfidData;
 Creature creature;
 
 // Creature list
@@ -58,6 +74,44 @@ bool cardProcessing = false;
 // Global WiFiClient
 WiFiClient client;
 
+// Reader whose tap is being handled; each pad keeps its own transaction and tap state
+ReaderContext *reader = &readers[0];
+ReaderContext *lastTapReader = &readers[0];
+
+// A blank card waits on its pad for the web form, then the form is written to it
+ReaderContext *formReader = nullptr;
+ReaderContext *pendingWriter = nullptr; // pad writing the web form data
+
+// Help desk: back up the next card tapped, or restore an image onto it
+enum class CardImageOp : uint8_t
+{
+    None,
+    Dump,
+    Restore
+};
+volatile CardImageOp cardImageOp = CardImageOp::None;
+String restoreUid; // image to restore, set by the web server
+CardImage cardImage;
+
+// Group tap results waiting for the game logic
+TapBuffer batchCards[MAX_BATCH_CARDS];
+uint8_t batchCount = 0;
+uint8_t batchNext = 0;
+ReaderContext *batchReader = &readers[0];
+
+// Tap latency per card family, for comparing Classic cards with Ultralight/NTAG stickers
+struct TapLatency
+{
+    uint32_t taps;
+    uint32_t totalMs;
+    uint32_t maxMs;
+};
+TapLatency classicLatency = {0, 0, 0};
+TapLatency ultralightLatency = {0, 0, 0};
+ProfileFields myProfile; // last profile read, decoded in place
+uint32_t profileRejects = 0;  // CRC failures and unknown record versions
+uint32_t lastTapApiMs = 0;    // name lookup and queueing; the network worker does the rest
+
 // Function prototypes
 void listSPIFFSFiles();
 void handleFormSubmit(AsyncWebServerRequest *request);
@@ -66,15 +120,25 @@ void stopWebServer();
 bool uidsMatch(MFRC522::Uid uid1, MFRC522::Uid uid2);
 void copyUid(MFRC522::Uid &dest, MFRC522::Uid &src);
 void clearUid(MFRC522::Uid &uid);
-bool writeToRFID(const String &data, byte blockAddr);
-void createOrUpdateUserOnServer();
-void exampleReadAndDecode(const String &rawRFID);
 void handleFormSubmit(AsyncWebServerRequest *request);
 void startWebServer();
 void clearUid(MFRC522::Uid &uid);
 bool sendCreatureToDatabase(const Creature &creature);
 bool checkForCreature(const Creature &creature);
-void add_5_coin(const String &customName);
+bool add_5_coin(const String &customName);
+ProfileError loadProfile(const byte *block);
+void processBatchCard(TapBuffer &card);
+void beginTap();
+void serviceReader();
+bool padsIdle();
+void serviceNetwork();
+bool anyCardPresent();
+ProfileError processTap(TapBuffer &tap, bool cardInField);
+void finishTap(const Creature &myCreature, bool cardInField = true);
+void showProvisionProgress();
+void runCardImageOp();
+String tapLatencyJson(const TapLatency &latency);
+void onCardWritten(const MFRC522::Uid &uid);
 
 // Setup
 void setup()
@@ -90,7 +154,14 @@ void setup()
 
     // Initialize SPI and RFID
     SPI.begin(SCK_PIN, MISO_PIN, MOSI_PIN, SS_PIN);
-    mfrc522.PCD_Init();
+    readersBegin();
+    for (uint8_t i = 0; i < READER_COUNT; i++)
+    {
+        readers[i].tx.session().setOnCardWritten(onCardWritten);
+    }
+    cardDetectBegin(mfrc522, IRQ_PIN);
+    provisionQueue.begin();
+    cardMigrator.begin();
     Serial.println("RFID Initialized");
     tft.println("RFID Initialized");
 
@@ -107,6 +178,9 @@ void setup()
         tft.println("SPIFFS Mount Failed");
         return;
     }
+    nameIndex.begin();
+    apiJournal.begin();
+    netWorker.begin();
 
     // Connect to Wi-Fi
     WiFi.begin(ssid, pass);
@@ -129,412 +203,624 @@ void setup()
     tft.println("Waiting for RFID...");
 
     Serial.println("[setup] Place an RFID card now to read...");
+    for (uint8_t i = 0; i < READER_COUNT; i++)
+    {
+        reader = &readers[i];
+        beginTap();
+    }
 }
 
 void loop()
 {
-    static bool initialized = false;
-
-    if (!initialized)
+    // Group tap: hand the queued cards to the game logic one per loop()
+    if (batchNext < batchCount)
     {
-        // Wait until a card is presented (optional, but ensures a single read at startup)
-        while (!mfrc522.PICC_IsNewCardPresent() || !mfrc522.PICC_ReadCardSerial())
+        reader = batchReader;
+        processBatchCard(batchCards[batchNext++]);
+        if (batchNext == batchCount)
         {
-            delay(200);
+            batchNext = batchCount = 0;
+            beginTap();
         }
-        Serial.println("card detected");
-        // Once a card is detected, read raw data from a specific block
-
-        // In setup(), after detecting a new card:
-        int myIntPart = 0;
-        String myStrPart;
+        return;
+    }
 
-        // Use the new readFromRFID signature
-        String rawData = readFromRFID(mfrc522, key, 1, myIntPart, myStrPart);
+    // Pads take turns on the shared SPI bus, one bounded reader step each,
+    // so a card on one pad never stalls the others
+    reader = &nextReader();
+    serviceReader();
+    if (reader->index == READER_COUNT - 1)
+    {
+        serviceNetwork();
+        // Let other tasks run once per round; with the pads idle, sleep until a card answers
+        cardDetectWait(padsIdle() ? CARD_IRQ_REARM_MS : 1);
+    }
+}
 
-        Serial.println("[setup] RFID Data read on reboot:");
-        Serial.println("intPart: " + String(myIntPart));
-        Serial.println("strPart: " + myStrPart);
+// Hand finished API requests back to their owners and queue new ones. The
+// network worker does the waiting, so this never blocks; flash and NVS
+// writes (journal, name index, RF tuning) wait until no card is on a pad.
+void serviceNetwork()
+{
+    NetResult result;
+    while (netWorker.poll(result))
+    {
+        switch (result.kind)
+        {
+        case NetRequestKind::Mutation:
+            apiJournal.complete(result.id, result.status);
+            break;
+        case NetRequestKind::RefreshNames:
+            nameIndex.apply(result);
+            break;
+        }
+    }
+    bool idle = padsIdle();
+    apiJournal.poll(idle);
+    nameIndex.poll(idle);
+    for (uint8_t i = 0; i < READER_COUNT; i++)
+    {
+        readers[i].tuner.poll(idle);
+    }
+}
 
-        // Check the bool values
-        bool A = (myIntPart & 0x01) != 0;
-        bool B = (myIntPart & 0x02) != 0;
-        bool C = (myIntPart & 0x04) != 0;
-        bool D = (myIntPart & 0x08) != 0;
+// No card on any pad and no form or group tap in progress
+bool padsIdle()
+{
+    if (formReader != nullptr || batchNext < batchCount)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < READER_COUNT; i++)
+    {
+        if (readers[i].tx.state() != RFIDTxState::WaitCard)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-        Serial.println("Bool A: " + String(A));
-        Serial.println("Bool B: " + String(B));
-        Serial.println("Bool C: " + String(C));
-        Serial.println("Bool D: " + String(D));
+// One scheduler turn for the current reader
+void serviceReader()
+{
+    RFIDTransaction &tx = reader->tx;
 
-        if (A && B && C && D)
+    // Card work advances one bounded step per turn so nothing stalls behind the reader
+    if (formReader == reader)
+    {
+        if (!formSubmitted)
         {
-            allChallBools = true;
-            Serial.println("[setup] allChallBools set to TRUE");
+            return;
         }
-        else
+        byte block[16];
+        encodeProfile(pendingData, block); // validated when the form was bound
+        tx.beginWrite(PROFILE_BLOCK, block); // same card, sector auth still open
+        formReader = nullptr;
+        pendingWriter = reader;
+        reader->blankCardWrite = true;
+    }
+    else if (dataPending && formReader == nullptr && pendingWriter == nullptr &&
+             !tx.isWrite() && tx.state() == RFIDTxState::WaitCard)
+    {
+        // Form data arrived while idle: write it to the next card presented on this pad
+        byte block[16];
+        encodeProfile(pendingData, block); // validated when the form was bound
+        tx.beginWrite(PROFILE_BLOCK, block, true);
+        pendingWriter = reader;
+        reader->blankCardWrite = false;
+    }
+    else if (cardImageOp == CardImageOp::None && reader->provisionJob == -1 && !tx.isWrite() &&
+             tx.state() == RFIDTxState::WaitCard)
+    {
+        // Provisioning: the next blank card presented gets the next queued profile.
+        // The tap's read goes ahead as usual and the write follows once the card reads blank.
+        ProfileFields job;
+        reader->provisionJob = provisionQueue.claim(job, reader->provisionGeneration);
+        if (reader->provisionJob != -1)
         {
-            allChallBools = false;
-            Serial.println("[setup] allChallBools set to FALSE");
+            encodeProfile(job, reader->provisionBlock);
+            reader->blankCardWrite = false;
+            Serial.println("[loop] Provisioning " + String(job.name) + ", present a card to reader " + String(reader->index));
         }
+    }
 
-        // If valid data came back, mark cardPresent true
-        if (rawData.indexOf('%') != -1)
+    bool wasWaiting = (tx.state() == RFIDTxState::WaitCard);
+    if (wasWaiting && reader->health.poll())
+    {
+        // Reader was wedged and has been re-initialised: start the wait over
+        beginTap();
+        return;
+    }
+    if (wasWaiting && reader->presence.poll() == PresenceEvent::Removed)
+    {
+        // Live status for /creatureStatus and the landing page
+        Serial.println("[loop] Card removed after " + String(reader->presence.removedAt() - reader->presence.presentSince()) + " ms");
+        cardPresent = anyCardPresent();
+    }
+    RFIDTxResult result = tx.poll();
+    if (wasWaiting && tx.state() != RFIDTxState::WaitCard)
+    {
+        Serial.println("card detected on reader " + String(reader->index));
+        reader->tapStart = millis();
+        lastCardUid = reader->mfrc522.uid;
+        reader->presence.track(lastCardUid);
+        cardPresent = true;
+
+        if (cardImageOp != CardImageOp::None && !tx.isWrite())
         {
-            // Card appears to have valid data
-            cardPresent = true;
-            Serial.println("[loop] Found '%', continuing...");
+            runCardImageOp();
+            tx.reset();
+            beginTap();
+            return;
         }
-        else
+
+        if (BATCH_SCAN_MODE && !tx.isWrite() && reader->provisionJob == -1)
         {
-            cardPresent = true;
-            tft.println("blank profile");
+            // Enumerate and read every card in the field now, process them after
+            batchCount = scanAllCards(reader->mfrc522, tx.session(), batchCards, MAX_BATCH_CARDS);
+            batchNext = 0;
+            batchReader = reader;
+            tx.reset();
+            return;
+        }
+
+        // Repeat tap of a card seen recently: serve the profile from RAM, skip auth + read
+        const ProfileCacheEntry *cached =
+            tx.isWrite() || reader->provisionJob != -1 ? nullptr : profileCache.lookup(lastCardUid);
+        if (cached)
+        {
+            Serial.println("[loop] Profile cache hit");
+            loadProfile(cached->block);
+            finishTap(cached->creature);
+            beginTap();
+            return;
+        }
+    }
+    if (result == RFIDTxResult::InProgress)
+    {
+        return;
+    }
 
-            while (!formSubmitted)
+    // Only failures the reader is to blame for count towards a reset; a card
+    // lifted early is the player's doing. The halt and beginTap() below run
+    // on the re-initialised chip just the same.
+    if (result == RFIDTxResult::Done || tx.failure() == RFIDTxFailure::OutOfRetries)
+    {
+        reader->health.reportResult(result == RFIDTxResult::Done);
+    }
+
+    if (tx.isWrite())
+    {
+        int provisionJob = reader->provisionJob;
+        if (result == RFIDTxResult::Done)
+        {
+            Serial.println("Write succeeded!");
+            tft.println("Write Succeeded!");
+            hasCreature = true; // Profile now exists
+            if (provisionJob != -1)
             {
-                delay(100); // Small delay to prevent overwhelming the CPU
+                provisionQueue.markWritten(provisionJob, reader->provisionGeneration, lastCardUid);
             }
-
-            if (writeRFIDData(mfrc522, key, pendingData))
+            else
             {
-                Serial.println("Write succeeded!");
-                tft.println("Write Succeeded!");
                 dataPending = false; // Clear pending state
-                hasCreature = true;  // Profile now exists
-                ESP.restart();
             }
-            else
+        }
+        else
+        {
+            Serial.println("Write failed!");
+            tft.println("Write Failed!");
+            hasCreature = false;
+            reader->stats.failed++;
+            if (provisionJob != -1)
             {
-                Serial.println("Write failed!");
-                tft.println("Write Failed!");
-                hasCreature = false;
+                provisionQueue.markFailed(provisionJob, reader->provisionGeneration); // retried on the next card
             }
+        }
 
+        if (pendingWriter == reader)
+        {
             // Reset the formSubmitted flag
             formSubmitted = false;
-
-            // Halt the card and stop encryption
-            mfrc522.PICC_HaltA();
-            mfrc522.PCD_StopCrypto1();
-            tft.println("end of writeing new card");
+            pendingWriter = nullptr;
         }
 
-        Serial.println("and here??");
-        Serial.println(rawData);
-
-        // Show the split parts
-        Serial.print("Integer part: ");
-        Serial.println(myIntPart);
-        Serial.print("String part: ");
-        Serial.println(myStrPart);
+        // Halt the card and stop encryption
+        reader->mfrc522.PICC_HaltA();
+        tx.session().end();
 
-        // Decode it into a Creature
-        Creature myCreature = decode(myIntPart, myStrPart);
-
-        // if customName is not empty, hasCreature = true
-        hasCreature = (myCreature.customName.length() > 0);
-
-        checkForCreature(myCreature);
-
-        if (newCreature == true)
-        {
-            sendCreatureToDatabase(myCreature);
-        }
-        else
-        {
-            Serial.println("Creature already exists." + myCreature.customName);
-            // return; // Exit the function early
-        }
-        // Show on TFT display
-        tft.fillScreen(TFT_BLACK);
-        tft.setCursor(0, 0);
-        tft.println("Hello " + myCreature.customName);
-
-        // Halt card so it won’t continue reading
-        mfrc522.PICC_HaltA();
-        mfrc522.PCD_StopCrypto1();
-        Serial.println("makes it to here");
-
-        // Assuming userId is available as myCreature.userId
-        if (allChallBools)
+        // Carry on with the profile just written; the card was halted above
+        if (reader->blankCardWrite && result == RFIDTxResult::Done && loadProfile(tx.data()) == ProfileError::Ok)
         {
-            add_5_coin(myCreature.customName);
-            tft.println("5 Coin added");
+            tft.println("end of writeing new card");
+            finishTap(decode(myProfile), false);
         }
-        else
+        if (provisionJob != -1)
         {
-            // tft.fillScreen(TFT_BLACK);
-            // tft.setCursor(0, 0);
-            tft.println("Challenges to be completed");
+            reader->provisionJob = -1;
+            showProvisionProgress();
         }
+        beginTap();
+        return;
+    }
 
-        initialized = true;
+    if (result == RFIDTxResult::Failed)
+    {
+        Serial.println("[loop] Card read failed, waiting for the card again");
+        reader->stats.failed++;
+        reader->mfrc522.PICC_HaltA();
+        beginTap();
+        return;
     }
 
-    // Handle Writing RFID Data
-    if (dataPending)
+    if (reader->provisionJob != -1 && !provisionQueue.isClaimed(reader->provisionJob, reader->provisionGeneration))
+    {
+        // The queue was cleared while this pad waited: carry on as a normal tap
+        reader->provisionJob = -1;
+    }
+    if (reader->provisionJob != -1)
     {
-        if (!cardProcessing && mfrc522.PICC_ReadCardSerial())
+        // Provisioning never writes over a profile: only a blank card gets the job
+        ProfileFields existing;
+        if (decodeProfile(tx.data(0), existing) == ProfileError::Blank) // tapBlocks[0] is PROFILE_BLOCK
         {
-            cardProcessing = true; // Start processing the card
-            cardPresent = true;    // Card is present
+            tx.beginWrite(PROFILE_BLOCK, reader->provisionBlock); // same card, sector auth still open
+            return;
+        }
+        Serial.println("[loop] Card not blank, present a blank card to provision");
+        tft.println("Card not blank");
+        provisionQueue.release(reader->provisionJob, reader->provisionGeneration);
+        reader->provisionJob = -1;
+        reader->mfrc522.PICC_HaltA();
+        tx.session().end();
+        beginTap();
+        return;
+    }
 
-            // Write pending data to RFID
-            if (writeRFIDData(mfrc522, key, pendingData))
-            {
-                Serial.println("Write succeeded!");
-                tft.println("Write Succeeded!");
-                dataPending = false; // Clear pending state
-                hasCreature = true;  // Profile now exists
-                ESP.restart();
-            }
-            else
-            {
-                Serial.println("Write failed!");
-                tft.println("Write Failed!");
-                hasCreature = false;
-            }
+    // Read done: everything the tap needs is in RAM now
+    TapBuffer &tapBuffer = reader->tapBuffer;
+    tapBuffer.uid = lastCardUid;
+    for (uint8_t i = 0; i < TAP_BLOCK_COUNT; i++)
+    {
+        memcpy(tapBuffer.blocks[i], tx.data(i), sizeof(tapBuffer.blocks[i]));
+    }
+    tapBuffer.loaded = true;
 
-            // Halt the card and stop encryption
-            mfrc522.PICC_HaltA();
-            mfrc522.PCD_StopCrypto1();
-            cardProcessing = false;
-            cardPresent = false;
-        }
-        else if (!mfrc522.PICC_IsNewCardPresent())
+    ProfileError profileError = processTap(tapBuffer, true);
+    if (profileRejected(profileError))
+    {
+        // Corrupt read or a newer record: never offer this card for overwriting
+        Serial.println("[loop] Profile rejected (" + String(profileErrorName(profileError)) + "), tap the card again");
+        tft.println("Card read error, tap again");
+        profileRejects++;
+        reader->stats.failed++;
+        reader->mfrc522.PICC_HaltA();
+        tx.session().end();
+        beginTap();
+        return;
+    }
+    if (profileError != ProfileError::Ok)
+    {
+        if (formReader != nullptr || pendingWriter != nullptr)
         {
-            // Card removed while waiting to write
-            cardProcessing = false;
-            cardPresent = false;
-            hasCreature = false;
+            // One web form at a time: this pad's card waits for the next tap
+            Serial.println("[loop] Blank card while another is being set up, try again shortly");
+            reader->mfrc522.PICC_HaltA();
+            tx.session().end();
+            beginTap();
+            return;
         }
+        tft.println("blank profile");
 
-        delay(100);
-        return; // Exit early since we're handling writing
+        // Keep this pad on the card until the web form arrives, then write it
+        formReader = reader;
+        return;
     }
-    delay(100);
+    beginTap();
 }
 
-// Example function to write raw data to block
-bool writeToRFID(const String &data, byte blockAddr)
+// Wait for the next card on the current reader and read every tap block as soon as it is selected
+void beginTap()
 {
-    MFRC522::StatusCode status;
-
-    // Authenticate with the card (using key A)
-    byte trailerBlock = (blockAddr / 4) * 4 + 3; // Trailer block for the sector
+    reader->tx.beginRead(tapBlocks, TAP_BLOCK_COUNT);
+}
 
-    // Default key for MIFARE cards (0xFF)
-    for (byte i = 0; i < 6; i++)
+bool anyCardPresent()
+{
+    for (uint8_t i = 0; i < READER_COUNT; i++)
     {
-        key.keyByte[i] = 0xFF;
+        if (readers[i].presence.isPresent())
+        {
+            return true;
+        }
     }
+    return false;
+}
 
-    Serial.print("Authenticating with trailer block ");
-    Serial.println(trailerBlock);
-
-    // Select the card
-    if (!mfrc522.PICC_IsNewCardPresent() || !mfrc522.PICC_ReadCardSerial())
+// Game logic for one card's read-ahead blocks. Returns the decode error for a
+// blank or unreadable profile. cardInField is false for group taps, where the
+// card was already halted.
+ProfileError processTap(TapBuffer &tap, bool cardInField)
+{
+    byte *profile = tap.block(PROFILE_BLOCK);
+    byte *coinBlock = tap.block(COIN_VALUE_BLOCK);
+    ProfileError error = loadProfile(profile);
+    if (error != ProfileError::Ok)
     {
-        Serial.println("No card selected or failed to read card serial.");
-        return false;
+        return error;
     }
 
-    // Authenticate
-    status = mfrc522.PCD_Authenticate(MFRC522::PICC_CMD_MF_AUTH_KEY_A, trailerBlock, &key, &(mfrc522.uid));
-    if (status != MFRC522::STATUS_OK)
+    Creature myCreature = decode(myProfile);
+    uint8_t cardVersion = profileVersion(profile); // before the coin move rewrites it
+
+    // Coins come from the value block. Legacy cards are migrated while the card
+    // is still selected; group-tap cards keep their digits until a single tap.
+    int32_t cardCoins = 0;
+    bool coinsLoaded = cardInField
+                           ? loadCoins(reader->tx.session(), profile, coinBlock, cardCoins)
+                           : (myProfile.bools & COINS_IN_VALUE_BLOCK) && decodeValueBlock(coinBlock, cardCoins);
+    if (coinsLoaded)
     {
-        Serial.print("PCD_Authenticate() failed: ");
-        Serial.println(mfrc522.GetStatusCodeName(status));
-        mfrc522.PICC_HaltA();
-        mfrc522.PCD_StopCrypto1();
-        return false;
+        myCreature.coins = cardCoins;
     }
+    myCreature.coinsOnCard = coinsLoaded;
 
-    Serial.println("Authentication successful");
+    // Older record layouts are brought up to date while the card is still selected
+    cardMigrator.migrate(cardInField ? &reader->tx.session() : nullptr, profile, cardVersion, reader->tapStart);
 
-    // Prepare data (must be 16 bytes)
-    byte dataBlock[16];
-    memset(dataBlock, 0, sizeof(dataBlock)); // Clear the array
-    data.toCharArray((char *)dataBlock, 16); // Convert string to char array
+    profileCache.store(tap.uid, profile, myCreature);
+    finishTap(myCreature, cardInField);
+    return ProfileError::Ok;
+}
 
-    // Write data to the card
-    Serial.print("Writing to block ");
-    Serial.println(blockAddr);
-    status = mfrc522.MIFARE_Write(blockAddr, dataBlock, 16);
-    if (status != MFRC522::STATUS_OK)
+// One card from a group tap. Blank cards are skipped since there is no
+// single card left in the field to write the web form to.
+void processBatchCard(TapBuffer &card)
+{
+    reader->tapStart = millis();
+    lastCardUid = card.uid;
+    if (!card.loaded)
     {
-        Serial.print("MIFARE_Write() failed: ");
-        Serial.println(mfrc522.GetStatusCodeName(status));
-        mfrc522.PICC_HaltA();
-        mfrc522.PCD_StopCrypto1();
-        return false;
+        Serial.println("[processBatchCard] Read failed, skipping card");
+        return;
     }
 
-    Serial.println("Write successful");
-
-    // Halt PICC and stop encryption on PCD
-    mfrc522.PICC_HaltA();
-    mfrc522.PCD_StopCrypto1();
+    const ProfileCacheEntry *cached = profileCache.lookup(card.uid);
+    if (cached)
+    {
+        loadProfile(cached->block);
+        finishTap(cached->creature, false);
+        return;
+    }
 
-    return true;
+    ProfileError error = processTap(card, false);
+    if (error != ProfileError::Ok)
+    {
+        Serial.println("[processBatchCard] No usable profile (" + String(profileErrorName(error)) + "), skipping card");
+        profileRejects += profileRejected(error) ? 1 : 0;
+    }
 }
 
-// Function to send decoded creature data to your Flask API
-bool sendCreatureToDatabase(const Creature &creature)
+// Decode a profile block into myProfile. Returns the decode error for a blank
+// or unreadable card.
+ProfileError loadProfile(const byte *block)
 {
-    if (WiFi.status() != WL_CONNECTED)
+    ProfileError error = decodeProfile(block, myProfile);
+    cardPresent = true;
+    if (error != ProfileError::Ok)
     {
-        Serial.println("WiFi not connected.");
-        return false;
+        Serial.print("[loadProfile] No profile: ");
+        Serial.println(profileErrorName(error));
+        allChallBools = false;
+        return error;
     }
 
-    Serial.println("WiFi connected. Starting HTTP POST request...");
-
-    WiFiClient wifiClient;
-    HttpClient http(wifiClient, "gameapi-2e9bb6e38339.herokuapp.com", 80);
+    Serial.print("[loadProfile] RFID Data read, bools 0x");
+    Serial.print(myProfile.bools, HEX);
+    Serial.print(", name ");
+    Serial.println(myProfile.name);
 
-    // Build JSON payload
-    String payload = "{";
-    payload += "\"age\":" + String(creature.trainerAge) + ",";
-    payload += "\"coins\":" + String(creature.coins) + ",";
-    payload += "\"creatureType\":" + String(creature.creatureType) + ",";
-    payload += "\"customName\":\"" + creature.customName + "\",";
-    payload += "\"intVal\":" + String(creature.intVal);
-    payload += "}";
+    // All four challenges A-D done
+    allChallBools = (myProfile.bools & BOOLS_MASK) == BOOLS_MASK;
+    Serial.println(allChallBools ? "[loadProfile] allChallBools set to TRUE" : "[loadProfile] allChallBools set to FALSE");
+    return ProfileError::Ok;
+}
 
-    Serial.println("Payload: " + payload);
+// Any write to a card makes its cached profile stale
+void onCardWritten(const MFRC522::Uid &uid)
+{
+    profileCache.invalidate(uid);
+}
 
-    // Connect to the server
-    if (wifiClient.connect("gameapi-2e9bb6e38339.herokuapp.com", 80))
+// Dump or restore the card just selected, while it is still in the field
+void runCardImageOp()
+{
+    RFIDSession &session = reader->tx.session();
+    bool ok;
+    tft.fillScreen(TFT_BLACK);
+    tft.setCursor(0, 0);
+    if (cardImageOp == CardImageOp::Dump)
     {
-        Serial.println("Connected to server.");
+        ok = dumpCard(reader->mfrc522, session, cardImage) && saveCardImage(cardImage);
+        tft.println(ok ? "Card backed up" : "Backup failed");
+    }
+    else
+    {
+        ok = loadCardImage(restoreUid, cardImage) && restoreCard(reader->mfrc522, session, cardImage);
+        tft.println(ok ? "Card restored" : "Restore failed");
+    }
+    tft.println(uidToHex(lastCardUid));
+    Serial.println("[runCardImageOp] " + String(ok ? "Done" : "Failed") + " in " + String(millis() - reader->tapStart) + " ms");
 
-        // Send HTTP POST request
-        http.beginRequest();
-        http.post("/api/v1/create_user_from_rfid");
-        http.sendHeader("Content-Type", "application/json");
-        http.sendHeader("Content-Length", payload.length());
-        http.beginBody();
-        http.print(payload);
-        http.endRequest();
+    reader->mfrc522.PICC_HaltA();
+    session.end();
+    cardImageOp = CardImageOp::None;
+}
 
-        Serial.println("HTTP POST request sent. Waiting for response...");
+// Provisioning progress on the TFT after each card
+void showProvisionProgress()
+{
+    tft.fillScreen(TFT_BLACK);
+    tft.setCursor(0, 0);
+    tft.println("Provisioning");
+    tft.println("Written: " + String(provisionQueue.written()) + "/" + String(provisionQueue.size()));
+    if (provisionQueue.failed() > 0)
+    {
+        tft.println("Failed: " + String(provisionQueue.failed()));
+    }
+    tft.println(String(provisionQueue.cardsPerMinute(), 1) + " cards/min");
+    tft.println(provisionQueue.hasQueued() ? "Next card please" : "Queue done");
+}
 
-        // Get the response status code
-        int statusCode = http.responseStatusCode();
-        String response = http.responseBody();
+String tapLatencyJson(const TapLatency &latency)
+{
+    String json = "{";
+    json += "\"taps\":" + String(latency.taps) + ",";
+    json += "\"avgMs\":" + String(latency.taps ? latency.totalMs / latency.taps : 0) + ",";
+    json += "\"maxMs\":" + String(latency.maxMs) + "}";
+    return json;
+}
 
-        if (statusCode > 0)
-        {
-            Serial.println("POST request sent successfully.");
-            Serial.println("Response code: " + String(statusCode));
-            Serial.println("Response: " + response);
-        }
-        else
-        {
-            Serial.print("Error: ");
-            Serial.println(statusCode);
-        }
+// Rest of the tap once the profile is known (or a blank card was written).
+// Card work comes first so the card can be lifted before the network calls.
+// cardInField is false for group taps, where the card was already halted.
+void finishTap(const Creature &myCreature, bool cardInField)
+{
+    Serial.println("and here??");
+    Serial.print("Profile digits: ");
+    Serial.println(profileDigits(myProfile));
+    Serial.print("Name: ");
+    Serial.println(myProfile.name);
+
+    // Award on the card itself: one increment + transfer on the coin value block.
+    // Without a value block (legacy or unreadable) the award is only journaled.
+    if (allChallBools && cardInField && myCreature.coinsOnCard)
+    {
+        awardCoins(reader->tx.session(), 5);
+    }
+    else if (allChallBools && cardInField)
+    {
+        Serial.println("[finishTap] No coin value block on the card, award journaled only");
+    }
 
-        // Close the connection
-        wifiClient.stop();
-        return (statusCode == 201);
+    // Halt card so it won’t continue reading
+    RFIDTransaction &tx = reader->tx;
+    reader->mfrc522.PICC_HaltA();
+    tx.session().end();
+    Serial.println("makes it to here");
+
+    uint32_t tapMs = millis() - reader->tapStart;
+    recordTap(*reader, tapMs);
+    lastTapReader = reader;
+    bool ultralight = MFRC522::PICC_GetType(lastCardUid.sak) == MFRC522::PICC_TYPE_MIFARE_UL;
+    TapLatency &latency = ultralight ? ultralightLatency : classicLatency;
+    latency.taps++;
+    latency.totalMs += tapMs;
+    latency.maxMs = max(latency.maxMs, tapMs);
+
+    Serial.print("[loop] Tap time (ms): ");
+    Serial.print(tapMs);
+    Serial.print(ultralight ? " (Ultralight)" : " (Classic)");
+    Serial.print(", auths: ");
+    Serial.print(tx.session().authCount());
+    Serial.print(", blocks written/skipped: ");
+    Serial.print(tx.session().writeCount());
+    Serial.print("/");
+    Serial.print(tx.session().blocksSkipped());
+    Serial.print(", longest reader step (us): ");
+    Serial.println(tx.maxPollUs());
+
+    // A named profile means a creature exists
+    hasCreature = myCreature.profile.name[0] != '\0';
+
+    unsigned long apiStart = millis();
+    checkForCreature(myCreature);
+
+    if (newCreature == true)
+    {
+        sendCreatureToDatabase(myCreature);
     }
     else
     {
-        Serial.println("Connection failed.");
-        return false;
+        Serial.println("Creature already exists." + String(myCreature.profile.name));
+        // return; // Exit the function early
     }
-}
-
-// Function to check if a creature is already in the database
-bool checkForCreature(const Creature &creature)
-{
-    if (WiFi.status() != WL_CONNECTED)
+    // Show on TFT display
+    tft.fillScreen(TFT_BLACK);
+    tft.setCursor(0, 0);
+    tft.println("Hello " + String(myCreature.profile.name));
+    if (READER_COUNT > 1)
     {
-        Serial.println("WiFi not connected.");
-        return false;
+        tft.println("Pad " + String(reader->index + 1));
     }
 
-    Serial.println("WiFi connected. Starting HTTP GET request...");
-
-    WiFiClient wifiClient;
-    HttpClient http(wifiClient, "gameapi-2e9bb6e38339.herokuapp.com", 80);
+    // Assuming userId is available as myCreature.userId
+    if (allChallBools)
+    {
+        tft.println(add_5_coin(myCreature.profile.name) ? "5 Coin added" : "Coin not saved");
+    }
+    else
+    {
+        // tft.fillScreen(TFT_BLACK);
+        // tft.setCursor(0, 0);
+        tft.println("Challenges to be completed");
+    }
 
-    // Send HTTP GET request
-    http.beginRequest();
-    http.get("/api/v1/get_custom_names");
-    http.sendHeader("Content-Type", "application/json");
-    http.endRequest();
+    lastTapApiMs = millis() - apiStart;
+    Serial.println("[finishTap] API work on the tap: " + String(lastTapApiMs) + " ms");
+}
 
-    Serial.println("HTTP GET request sent. Waiting for response...");
+// Function to send decoded creature data to your Flask API
+bool sendCreatureToDatabase(const Creature &creature)
+{
+    // Build JSON payload from the profile schema; coins come from the value block
+    JsonDocument doc;
+    profileToJson(creature.profile, doc.to<JsonObject>());
+    doc["coins"] = creature.coins;
+    String payload;
+    serializeJson(doc, payload);
 
-    // Get the response status code
-    int statusCode = http.responseStatusCode();
-    String response = http.responseBody();
+    Serial.println("Payload: " + payload);
 
-    if (statusCode > 0)
+    // Sent from the journal in the background; the name counts as known now
+    // so a second tap before then doesn't queue the creature twice
+    if (!apiJournal.enqueue(JournalKind::CreateCreature, payload))
     {
-        Serial.println("GET request sent successfully.");
-        Serial.println("Response code: " + String(statusCode));
-        Serial.println("Response: " + response);
-
-        // Check if the customName is in the response
-        if (response.indexOf("\"" + creature.customName + "\"") == -1)
-        {
-            newCreature = true;
-            Serial.println("New creature detected: " + creature.customName);
-        }
-        else
-        {
-            newCreature = false;
-            Serial.println("creature already exists: " + creature.customName);
-        }
+        return false;
     }
-    else
+    nameIndex.add(creature.profile.name);
+    return true;
+}
+
+// Function to check if a creature is already in the database
+bool checkForCreature(const Creature &creature)
+{
+    // The local index answers without the server. Until a unit has fetched
+    // the name list once the answer is unknown: don't create a duplicate,
+    // the card is checked again on its next tap.
+    if (!nameIndex.ready())
     {
-        Serial.print("Error: ");
-        Serial.println(statusCode);
+        newCreature = false;
+        Serial.println("Name list not loaded yet, creature check skipped: " + String(creature.profile.name));
+        return false;
     }
 
-    // Close the connection
-    wifiClient.stop();
-    return (statusCode == 200);
+    newCreature = !nameIndex.contains(creature.profile.name);
+    Serial.println(String(newCreature ? "New creature detected: " : "creature already exists: ") + creature.profile.name);
+    return true;
 }
-// ...existing code...
 void handleFormSubmit(AsyncWebServerRequest *request)
 {
-    // Indicate that a form has been submitted, used by other parts of the program
-    Serial.print("should change form bool here");
-    formSubmitted = true;
-
     // Only proceed if the request is an HTTP POST
     if (request->method() == HTTP_POST)
     {
-        // Ensure the required parameters are present
-        if (request->hasParam("age", true) &&
-            request->hasParam("coins", true) &&
-            request->hasParam("creatureType", true) &&
-            request->hasParam("name", true))
+        ProfileFields submitted;
+        ProfileError error = bindProfileForm(request, submitted);
+        if (error == ProfileError::Ok)
         {
-            // Extract form data from request and populate pendingData
-            pendingData.age = request->getParam("age", true)->value().toInt();
-            pendingData.coins = request->getParam("coins", true)->value().toInt();
-            pendingData.creatureType = request->getParam("creatureType", true)->value().toInt();
-            pendingData.name = request->getParam("name", true)->value();
-
-            // Convert checkbox values into a single encoded integer (encodeBools is defined elsewhere)
-            bool A = request->hasParam("A", true);
-            bool B = request->hasParam("B", true);
-            bool C = request->hasParam("C", true);
-            bool D = request->hasParam("D", true);
-            pendingData.bools = encodeBools(A, B, C, D);
-            /*
-                        // If all checkboxes are true, set this special boolean flag
-                        if (A && B && C && D) {
-                            allChallBools = true;
-                        }
-            */
+            pendingData = submitted;
+
             // Debug output to the serial monitor
             Serial.println("[handleFormSubmit] Received NEW form data:");
             Serial.print(" Age: ");
@@ -549,6 +835,7 @@ void handleFormSubmit(AsyncWebServerRequest *request)
             Serial.println(pendingData.name);
 
             // Notify other code that new form data is ready to be processed
+            formSubmitted = true;
             dataPending = true;
             Serial.println("[handleFormSubmit] dataPending set to TRUE.");
 
@@ -557,12 +844,11 @@ void handleFormSubmit(AsyncWebServerRequest *request)
         }
         else
         {
-            // Inform the client that not all expected parameters were provided
-            request->send(400, "text/html", "Missing parameters!");
+            // Missing or out-of-range field: nothing is written
+            request->send(400, "text/html", "Bad profile: " + String(profileErrorName(error)));
         }
     }
 }
-// ...existing code...
 
 // Start the web server
 void startWebServer()
@@ -589,13 +875,148 @@ void startWebServer()
         // Handle form submission
         server.on("/submit", HTTP_POST, handleFormSubmit);
 
+        // Provisioning: queue profiles (one form entry or an uploaded list) for successive cards
+        server.on("/provision", HTTP_GET, [](AsyncWebServerRequest *request)
+                  {
+            if (SPIFFS.exists("/provision.html")) {
+                request->send(SPIFFS, "/provision.html", "text/html");
+            } else {
+                request->send(404, "text/plain", "File Not Found");
+            } });
+
+        server.on("/provision", HTTP_POST, [](AsyncWebServerRequest *request)
+                  {
+            uint8_t added = 0;
+            if (request->hasParam("list", true)) {
+                added = provisionQueue.addList(request->getParam("list", true)->value());
+            } else {
+                ProfileFields job;
+                if (bindProfileForm(request, job) == ProfileError::Ok && provisionQueue.add(job)) {
+                    added = 1;
+                }
+            }
+            Serial.println("[provision] Queued " + String(added) + " profiles");
+            if (added == 0) {
+                request->send(400, "text/html", "No profiles queued!");
+                return;
+            }
+            request->redirect("/provision"); });
+
+        server.on("/provisionStatus", HTTP_GET, [](AsyncWebServerRequest *request)
+                  { request->send(200, "application/json", provisionQueue.statusJson()); });
+
+        server.on("/provisionClear", HTTP_POST, [](AsyncWebServerRequest *request)
+                  {
+            provisionQueue.clear();
+            request->send(200, "text/plain", "Provisioning queue cleared"); });
+
+        // Card images: back up a card, restore it onto a replacement, download the image
+        server.on("/cardImage/dump", HTTP_POST, [](AsyncWebServerRequest *request)
+                  {
+            cardImageOp = CardImageOp::Dump;
+            request->send(200, "text/plain", "Tap the card to back up"); });
+
+        server.on("/cardImage/restore", HTTP_POST, [](AsyncWebServerRequest *request)
+                  {
+            if (!request->hasParam("uid", true) || !SPIFFS.exists(cardImagePath(request->getParam("uid", true)->value()))) {
+                request->send(404, "text/plain", "No image for that card");
+                return;
+            }
+            restoreUid = request->getParam("uid", true)->value();
+            cardImageOp = CardImageOp::Restore;
+            request->send(200, "text/plain", "Tap the replacement card"); });
+
+        server.on("/cardImage/list", HTTP_GET, [](AsyncWebServerRequest *request)
+                  { request->send(200, "application/json", listCardImagesJson()); });
+
+        server.on("/cardImage/download", HTTP_GET, [](AsyncWebServerRequest *request)
+                  {
+            String path = request->hasParam("uid") ? cardImagePath(request->getParam("uid")->value()) : "";
+            if (path.length() > 0 && SPIFFS.exists(path)) {
+                request->send(SPIFFS, path, "application/octet-stream", true);
+            } else {
+                request->send(404, "text/plain", "File Not Found");
+            } });
+
         // Endpoint to check creature status
         server.on("/creatureStatus", HTTP_GET, [](AsyncWebServerRequest *request)
                   {
             // Build JSON with cardPresent and hasCreature
             String response = "{";
             response += "\"cardPresent\":" + String(cardPresent ? "true" : "false") + ",";
-            response += "\"hasCreature\":" + String(hasCreature ? "true" : "false") + "}";
+            response += "\"hasCreature\":" + String(hasCreature ? "true" : "false") + ",";
+            response += "\"changedMsAgo\":" + String(millis() - (cardPresent ? lastTapReader->presence.presentSince() : lastTapReader->presence.removedAt())) + "}";
+            request->send(200, "application/json", response); });
+
+        // Profile codec cost and fuzz pass, e.g. /codecBench?n=5000&fuzz=20000
+        server.on("/codecBench", HTTP_GET, [](AsyncWebServerRequest *request)
+                  {
+            uint32_t iterations = request->hasParam("n") ? request->getParam("n")->value().toInt() : CODEC_BENCH_ITERATIONS;
+            uint32_t fuzzBlocks = request->hasParam("fuzz") ? request->getParam("fuzz")->value().toInt() : CODEC_BENCH_FUZZ_BLOCKS;
+            request->send(200, "application/json", codecBenchJson(runCodecBench(iterations, fuzzBlocks))); });
+
+        // Streamed vs buffered name list parsing, e.g. /apiBench?n=20000
+        server.on("/apiBench", HTTP_GET, [](AsyncWebServerRequest *request)
+                  {
+            uint32_t names = request->hasParam("n") ? request->getParam("n")->value().toInt() : API_BENCH_NAMES;
+            request->send(200, "application/json", apiBenchJson(runApiBench(names))); });
+
+        // Runtime counters for sizing caches and tuning the station
+        server.on("/stats", HTTP_GET, [](AsyncWebServerRequest *request)
+                  {
+            String response = "{";
+            response += "\"profileCache\":{";
+            response += "\"hits\":" + String(profileCache.hits()) + ",";
+            response += "\"misses\":" + String(profileCache.misses()) + ",";
+            response += "\"evictions\":" + String(profileCache.evictions()) + ",";
+            response += "\"entries\":" + String(profileCache.size()) + ",";
+            response += "\"ttlMs\":" + String(profileCache.ttl()) + "},";
+            const CardScanStats &scan = cardScanStats();
+            response += "\"batchScan\":{";
+            response += "\"scans\":" + String(scan.scans) + ",";
+            response += "\"cards\":" + String(scan.cards) + ",";
+            response += "\"lastCount\":" + String(scan.lastCount) + ",";
+            response += "\"lastMs\":" + String(scan.lastMs) + ",";
+            response += "\"lastCardsPerSec\":" + String(scan.lastCardsPerSec) + "},";
+            response += "\"lastTap\":{";
+            response += "\"reader\":" + String(lastTapReader->index) + ",";
+            response += "\"auths\":" + String(lastTapReader->tx.session().authCount()) + ",";
+            response += "\"blocksWritten\":" + String(lastTapReader->tx.session().writeCount()) + ",";
+            response += "\"blocksSkipped\":" + String(lastTapReader->tx.session().blocksSkipped()) + ",";
+            response += "\"apiMs\":" + String(lastTapApiMs) + "},";
+            response += "\"api\":" + gameApi.statsJson() + ",";
+            response += "\"cardDetect\":" + cardDetectStatsJson() + ",";
+            response += "\"tapLatency\":{";
+            response += "\"classic\":" + tapLatencyJson(classicLatency) + ",";
+            response += "\"ultralight\":" + tapLatencyJson(ultralightLatency) + "},";
+            response += "\"readers\":[";
+            for (uint8_t i = 0; i < READER_COUNT; i++) {
+                const ReaderContext &r = readers[i];
+                response += (i > 0 ? ",{" : "{");
+                response += "\"steps\":" + String(r.stats.steps) + ",";
+                response += "\"taps\":" + String(r.stats.taps) + ",";
+                response += "\"failed\":" + String(r.stats.failed) + ",";
+                response += "\"avgTapMs\":" + String(r.stats.taps ? r.stats.totalTapMs / r.stats.taps : 0) + ",";
+                response += "\"maxTapMs\":" + String(r.stats.maxTapMs) + ",";
+                response += "\"presenceTracking\":" + String(r.presence.tracking() ? "true" : "false") + ",";
+                response += "\"presenceChecks\":" + String(r.presence.checks()) + ",";
+                response += "\"lastPresenceCheckUs\":" + String(r.presence.lastCheckUs()) + ",";
+                response += "\"rf\":" + r.tuner.statsJson() + ",";
+                response += "\"health\":" + r.health.statsJson() + "}";
+            }
+            response += "],";
+            response += "\"profileRecords\":{";
+            response += "\"rejected\":" + String(profileRejects) + "},";
+            response += "\"migration\":" + cardMigrator.statsJson() + ",";
+            response += "\"nameIndex\":" + nameIndex.statsJson() + ",";
+            response += "\"journal\":" + apiJournal.statsJson() + ",";
+            response += "\"netWorker\":" + netWorker.statsJson() + ",";
+            response += "\"provisioning\":{";
+            response += "\"jobs\":" + String(provisionQueue.size()) + ",";
+            response += "\"written\":" + String(provisionQueue.written()) + ",";
+            response += "\"failed\":" + String(provisionQueue.failed()) + ",";
+            response += "\"cardsPerMinute\":" + String(provisionQueue.cardsPerMinute()) + "}";
+            response += "}";
             request->send(200, "application/json", response); });
 
         // Start the server
@@ -618,19 +1039,8 @@ void clearUid(MFRC522::Uid &uid)
     }
 }
 
-void add_5_coin(const String &customName)
+bool add_5_coin(const String &customName)
 {
-    if (WiFi.status() != WL_CONNECTED)
-    {
-        Serial.println("[add_5_coin] WiFi not connected.");
-        return;
-    }
-
-    Serial.println("[add_5_coin] WiFi connected. Starting HTTP POST request...");
-
-    WiFiClient wifiClient;
-    HttpClient http(wifiClient, "gameapi-2e9bb6e38339.herokuapp.com", 80);
-
     // Build JSON payload
     String payload = "{";
     payload += "\"customName\":\"" + customName + "\"";
@@ -638,42 +1048,6 @@ void add_5_coin(const String &customName)
 
     Serial.println("[add_5_coin] Payload: " + payload);
 
-    // Connect to the server
-    if (wifiClient.connect("gameapi-2e9bb6e38339.herokuapp.com", 80))
-    {
-        Serial.println("[add_5_coin] Connected to server.");
-
-        // Send HTTP POST request
-        http.beginRequest();
-        http.post("/api/v1/add_5_coin");
-        http.sendHeader("Content-Type", "application/json");
-        http.sendHeader("Content-Length", payload.length());
-        http.beginBody();
-        http.print(payload);
-        http.endRequest();
-
-        Serial.println("[add_5_coin] HTTP POST request sent. Waiting for response...");
-
-        // Get the response
-        int statusCode = http.responseStatusCode();
-        String response = http.responseBody();
-
-        if (statusCode > 0)
-        {
-            Serial.println("[add_5_coin] Response code: " + String(statusCode));
-            Serial.println("[add_5_coin] Response: " + response);
-        }
-        else
-        {
-            Serial.print("[add_5_coin] Error, status code: ");
-            Serial.println(statusCode);
-        }
-
-        // Close the connection
-        wifiClient.stop();
-    }
-    else
-    {
-        Serial.println("[add_5_coin] Connection failed.");
-    }
+    return apiJournal.enqueue(JournalKind::AddCoins, payload);
 }
+
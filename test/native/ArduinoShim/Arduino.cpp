@@ -0,0 +1,345 @@
+#include "Arduino.h"
+#include "SPI.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+
+static const std::chrono::steady_clock::time_point clockStart = std::chrono::steady_clock::now();
+static std::atomic<uint64_t> addedMicros(0);
+static std::atomic<bool> realClock(true);
+static bool serialEcho = false;
+static uint32_t randomState = 0x2545F491;
+static uint32_t restarts = 0;
+
+#define SHIM_PINS 64
+static void (*pinHandlers[SHIM_PINS])(void);
+
+void shimUseRealClock(bool on)
+{
+    realClock = on;
+}
+
+void shimAdvanceMicros(uint64_t us)
+{
+    addedMicros += us;
+}
+
+void shimSerialEcho(bool on)
+{
+    serialEcho = on;
+}
+
+void shimSeedRandom(uint32_t seed)
+{
+    randomState = seed ? seed : 1;
+}
+
+uint32_t shimRestarts()
+{
+    return restarts;
+}
+
+static uint64_t nowMicros()
+{
+    uint64_t now = addedMicros;
+    if (realClock)
+    {
+        now += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clockStart)
+                   .count();
+    }
+    return now;
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(nowMicros() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)nowMicros();
+}
+
+void delay(unsigned long ms)
+{
+    if (realClock)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+    else
+    {
+        shimAdvanceMicros(ms * 1000ULL);
+    }
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (realClock)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+    else
+    {
+        shimAdvanceMicros(us);
+    }
+}
+
+void yield()
+{
+    std::this_thread::yield();
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    return HIGH;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode)
+{
+    if (pin < SHIM_PINS)
+    {
+        pinHandlers[pin] = handler;
+    }
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    if (pin < SHIM_PINS)
+    {
+        pinHandlers[pin] = nullptr;
+    }
+}
+
+void shimRaiseInterrupt(uint8_t pin)
+{
+    if (pin < SHIM_PINS && pinHandlers[pin])
+    {
+        pinHandlers[pin]();
+    }
+}
+
+uint32_t esp_random()
+{
+    // xorshift32: repeatable for a given seed
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (serialEcho)
+    {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (serialEcho)
+    {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+void EspClass::restart()
+{
+    restarts++;
+}
+
+void shimEnterCritical(portMUX_TYPE *mux)
+{
+    while (__atomic_exchange_n(&mux->locked, 1, __ATOMIC_ACQUIRE))
+    {
+        std::this_thread::yield();
+    }
+}
+
+void shimExitCritical(portMUX_TYPE *mux)
+{
+    __atomic_store_n(&mux->locked, 0, __ATOMIC_RELEASE);
+}
+
+// Tasks: one host thread each, with a notification count
+
+struct ShimTask
+{
+    std::mutex lock;
+    std::condition_variable changed;
+    uint32_t notifications = 0;
+};
+
+static thread_local ShimTask currentTask;
+
+// ticks are milliseconds; portMAX_DELAY waits forever
+template <typename Predicate>
+static bool waitFor(std::condition_variable &changed, std::unique_lock<std::mutex> &hold, TickType_t ticks,
+                    Predicate ready)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        changed.wait(hold, ready);
+        return true;
+    }
+    return changed.wait_for(hold, std::chrono::milliseconds(ticks), ready);
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *name, uint32_t stackDepth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    std::thread(task, arg).detach();
+    if (handle)
+    {
+        *handle = nullptr; // the firmware never addresses another task by handle
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return &currentTask;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    delay(ticks);
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return millis();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> hold(currentTask.lock);
+    waitFor(currentTask.changed, hold, ticks, [] { return currentTask.notifications > 0; });
+    uint32_t count = currentTask.notifications;
+    if (count > 0)
+    {
+        currentTask.notifications = clearOnExit ? 0 : count - 1;
+    }
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    if (task)
+    {
+        std::lock_guard<std::mutex> hold(task->lock);
+        task->notifications++;
+        task->changed.notify_all();
+    }
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken)
+    {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+// Queues: fixed-size items copied in and out, as FreeRTOS does
+
+struct ShimQueue
+{
+    ShimQueue(UBaseType_t length, UBaseType_t itemSize) : length(length), itemSize(itemSize) {}
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    return new ShimQueue(length, itemSize);
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> hold(queue->lock);
+    if (!waitFor(queue->changed, hold, ticks, [queue] { return queue->items.size() < queue->length; }))
+    {
+        return pdFALSE;
+    }
+    const uint8_t *bytes = (const uint8_t *)item;
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> hold(queue->lock);
+    if (!waitFor(queue->changed, hold, ticks, [queue] { return !queue->items.empty(); }))
+    {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> hold(queue->lock);
+    return queue->items.size();
+}
+
+// Mutexes: recursive, like the firmware's use of them allows
+
+struct ShimMutex
+{
+    std::recursive_timed_mutex lock;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new ShimMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        mutex->lock.lock();
+        return pdTRUE;
+    }
+    return mutex->lock.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+    mutex->lock.unlock();
+    return pdTRUE;
+}
@@ -0,0 +1,149 @@
+// Arduino.h
+// Host build of the parts of the Arduino core, ESP32 and FreeRTOS APIs the
+// firmware uses, for the native test environment. Time comes from a clock
+// tests can drive, so device fakes can charge what each operation costs on
+// the real hardware. FreeRTOS queues, tasks and notifications map onto host
+// threads.
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::max;
+using std::min;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define PROGMEM
+#define IRAM_ATTR
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define digitalPinToInterrupt(pin) (pin)
+
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isHexadecimalDigit(int c) { return isxdigit(c) != 0; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isAlphaNumeric(int c) { return isalnum(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+inline bool isWhitespace(int c) { return c == ' ' || c == '\t'; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+uint32_t esp_random();
+inline long random(long howBig) { return howBig > 0 ? esp_random() % howBig : 0; }
+inline long random(long howSmall, long howBig) { return howSmall < howBig ? howSmall + random(howBig - howSmall) : howSmall; }
+
+class HardwareSerial : public Stream
+{
+public:
+    using Print::write;
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMaxAllocHeap() { return 110000; }
+    uint64_t getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+    void restart();
+};
+extern EspClass ESP;
+
+// FreeRTOS, as the ESP32 core pulls it in through Arduino.h
+typedef struct ShimTask *TaskHandle_t;
+typedef struct ShimQueue *QueueHandle_t;
+typedef struct ShimMutex *SemaphoreHandle_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(...)
+
+typedef struct
+{
+    volatile int locked;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void shimEnterCritical(portMUX_TYPE *mux);
+void shimExitCritical(portMUX_TYPE *mux);
+#define portENTER_CRITICAL(mux) shimEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) shimExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) shimEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) shimExitCritical(mux)
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *name, uint32_t stackDepth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
+
+// Test controls
+//
+// millis()/micros() are the host's steady clock plus whatever time has been
+// added with shimAdvanceMicros(). With the real clock off only added time
+// counts, so a simulation gives the same numbers on every run; delay() then
+// adds its time instead of sleeping.
+void shimUseRealClock(bool on);
+void shimAdvanceMicros(uint64_t us);
+void shimSerialEcho(bool on);             // copy Serial output to stdout (off by default)
+void shimRaiseInterrupt(uint8_t pin);     // run the handler attached to pin, as the ISR would
+void shimSeedRandom(uint32_t seed);       // esp_random() sequence
+uint32_t shimRestarts();                  // ESP.restart() calls
+
+#endif // ARDUINO_H
@@ -0,0 +1,190 @@
+#include "SPIFFS.h"
+#include <map>
+#include <string>
+#include <vector>
+
+SPIFFSFS SPIFFS;
+
+typedef std::vector<uint8_t> FileData;
+static std::map<std::string, std::shared_ptr<FileData>> files;
+static bool failWrites = false;
+static bool failRenames = false;
+
+namespace fs
+{
+
+struct FileImpl
+{
+    std::string path;
+    std::shared_ptr<FileData> data; // null for the root directory
+    size_t position = 0;
+    bool writable = false;
+    std::vector<std::string> listing;
+    size_t next = 0;
+};
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+    if (!_impl || !_impl->writable || failWrites)
+    {
+        return 0;
+    }
+    FileData &data = *_impl->data;
+    if (_impl->position + size > data.size())
+    {
+        data.resize(_impl->position + size);
+    }
+    memcpy(data.data() + _impl->position, buffer, size);
+    _impl->position += size;
+    return size;
+}
+
+int File::available()
+{
+    return _impl && _impl->data ? (int)(_impl->data->size() - _impl->position) : 0;
+}
+
+int File::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek()
+{
+    return available() > 0 ? (*_impl->data)[_impl->position] : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+    size_t count = std::min(size, (size_t)available());
+    if (count > 0)
+    {
+        memcpy(buffer, _impl->data->data() + _impl->position, count);
+        _impl->position += count;
+    }
+    return count;
+}
+
+bool File::seek(uint32_t position)
+{
+    if (!_impl || !_impl->data || position > _impl->data->size())
+    {
+        return false;
+    }
+    _impl->position = position;
+    return true;
+}
+
+size_t File::position() const
+{
+    return _impl ? _impl->position : 0;
+}
+
+size_t File::size() const
+{
+    return _impl && _impl->data ? _impl->data->size() : 0;
+}
+
+const char *File::name() const
+{
+    return _impl ? _impl->path.c_str() : "";
+}
+
+bool File::isDirectory() const
+{
+    return _impl && !_impl->data;
+}
+
+File File::openNextFile(const char *mode)
+{
+    if (!isDirectory() || _impl->next >= _impl->listing.size())
+    {
+        return File();
+    }
+    return SPIFFS.open(_impl->listing[_impl->next++].c_str(), mode);
+}
+
+File FS::open(const char *path, const char *mode, bool create)
+{
+    auto impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    if (strcmp(path, "/") == 0)
+    {
+        for (const auto &file : files)
+        {
+            impl->listing.push_back(file.first);
+        }
+        return File(impl);
+    }
+
+    auto found = files.find(path);
+    if (mode[0] == 'r')
+    {
+        if (found == files.end())
+        {
+            return File();
+        }
+        impl->data = found->second;
+        return File(impl);
+    }
+
+    if (mode[0] == 'w' || found == files.end())
+    {
+        files[path] = std::make_shared<FileData>();
+    }
+    impl->data = files[path];
+    impl->writable = true;
+    impl->position = mode[0] == 'a' ? impl->data->size() : 0;
+    return File(impl);
+}
+
+bool FS::exists(const char *path)
+{
+    return files.count(path) > 0;
+}
+
+bool FS::remove(const char *path)
+{
+    return files.erase(path) > 0;
+}
+
+// As on SPIFFS, a rename never replaces an existing file
+bool FS::rename(const char *from, const char *to)
+{
+    auto found = files.find(from);
+    if (found == files.end() || files.count(to) > 0 || failRenames)
+    {
+        return false;
+    }
+    files[to] = found->second;
+    files.erase(std::string(from));
+    return true;
+}
+
+} // namespace fs
+
+size_t SPIFFSFS::usedBytes()
+{
+    size_t used = 0;
+    for (const auto &file : files)
+    {
+        used += file.second->size();
+    }
+    return used;
+}
+
+void shimFormatFs()
+{
+    files.clear();
+}
+
+void shimFailFsWrites(bool fail)
+{
+    failWrites = fail;
+}
+
+void shimFailFsRenames(bool fail)
+{
+    failRenames = fail;
+}
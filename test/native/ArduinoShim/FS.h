@@ -0,0 +1,72 @@
+// FS.h
+// The Arduino-ESP32 file API over an in-memory file system. Files outlive
+// the File objects that wrote them, as they would in flash, until the test
+// formats the volume.
+#ifndef FS_H
+#define FS_H
+
+#include "Arduino.h"
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+
+struct FileImpl;
+
+class File : public Stream
+{
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : _impl(impl) {}
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t *buffer, size_t size);
+    bool seek(uint32_t position);
+    size_t position() const;
+    size_t size() const;
+    const char *name() const;
+    bool isDirectory() const;
+    File openNextFile(const char *mode = FILE_READ);
+    void close() { _impl.reset(); }
+    operator bool() const { return _impl != nullptr; }
+
+private:
+    std::shared_ptr<FileImpl> _impl;
+};
+
+class FS
+{
+public:
+    File open(const char *path, const char *mode = FILE_READ, bool create = false);
+    File open(const String &path, const char *mode = FILE_READ, bool create = false)
+    {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to);
+    bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+// Test controls
+void shimFormatFs();                // delete every file
+void shimFailFsWrites(bool fail);   // writes return 0 bytes, as on a full or failing flash
+void shimFailFsRenames(bool fail);  // rename() returns false
+
+#endif // FS_H
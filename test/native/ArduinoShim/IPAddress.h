@@ -0,0 +1,34 @@
+// IPAddress.h
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include "Arduino.h"
+
+class IPAddress : public Printable
+{
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { set(a, b, c, d); }
+    IPAddress(uint32_t address) : _address(address) {}
+
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return (_address >> (8 * index)) & 0xFF; }
+    bool operator==(const IPAddress &other) const { return _address == other._address; }
+
+    String toString() const
+    {
+        return String((*this)[0]) + "." + String((*this)[1]) + "." + String((*this)[2]) + "." + String((*this)[3]);
+    }
+    size_t printTo(Print &p) const override { return p.print(toString()); }
+
+private:
+    // first octet in the low byte, as lwIP stores it
+    void set(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        _address = (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+    }
+
+    uint32_t _address;
+};
+
+#endif // IPADDRESS_H
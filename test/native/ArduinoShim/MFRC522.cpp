@@ -0,0 +1,589 @@
+#include "MFRC522.h"
+#include <algorithm>
+
+FakeCard::FakeCard(uint32_t uidValue, byte sak) : state(Idle), inField(false), failAuths(0), failReads(0), failWrites(0)
+{
+    uid.size = 4;
+    for (byte i = 0; i < 4; i++)
+    {
+        uid.uidByte[i] = (uidValue >> (24 - 8 * i)) & 0xFF;
+    }
+    uid.sak = sak;
+
+    memset(blocks, 0, sizeof(blocks));
+    memcpy(blocks[0], uid.uidByte, 4);
+    if (!isUltralight())
+    {
+        static const byte trailer[16] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07,
+                                         0x80, 0x69, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        for (byte sector = 0; sector < 16; sector++)
+        {
+            memcpy(blocks[sector * 4 + 3], trailer, 16);
+        }
+    }
+}
+
+void FakeCard::setValueBlock(byte blockAddr, int32_t value)
+{
+    byte *block = blocks[blockAddr];
+    for (byte i = 0; i < 4; i++)
+    {
+        block[i] = block[i + 8] = (value >> (8 * i)) & 0xFF;
+        block[i + 4] = ~block[i];
+    }
+    block[12] = block[14] = blockAddr;
+    block[13] = block[15] = ~blockAddr;
+}
+
+bool FakeCard::isValueBlock(byte blockAddr) const
+{
+    const byte *block = blocks[blockAddr];
+    for (byte i = 0; i < 4; i++)
+    {
+        if (block[i] != block[i + 8] || block[i + 4] != (byte)~block[i])
+        {
+            return false;
+        }
+    }
+    return block[12] == block[14] && block[13] == block[15] && block[13] == (byte)~block[12];
+}
+
+MFRC522::MFRC522()
+    : fakeCounters(), fakeIrqPin(-1), _gain(RxGain_avg), _comIEn(0), _fifo(0), _command(PCD_Idle), _crypto(false),
+      _authSector(-1), _valueLoaded(false), _valueRegister(0)
+{
+    memset(&uid, 0, sizeof(uid));
+}
+
+MFRC522::MFRC522(byte resetPowerDownPin) : MFRC522()
+{
+}
+
+MFRC522::MFRC522(byte chipSelectPin, byte resetPowerDownPin) : MFRC522()
+{
+}
+
+void MFRC522::charge(uint32_t us)
+{
+    fakeCounters.frames++;
+    shimAdvanceMicros(us);
+}
+
+void MFRC522::fakeInsert(FakeCard &card)
+{
+    card.state = FakeCard::Idle;
+    card.inField = true;
+    _field.push_back(&card);
+}
+
+void MFRC522::fakeRemove(FakeCard &card)
+{
+    card.inField = false;
+    _field.erase(std::remove(_field.begin(), _field.end(), &card), _field.end());
+}
+
+// Forget the cards without touching them: a test's cards may already be gone
+void MFRC522::fakeClearField()
+{
+    _field.clear();
+}
+
+// Registers: enough of the chip for CardDetect's IRQ arming. Sending REQA
+// with RxIEn set raises the IRQ line once a card answers.
+void MFRC522::PCD_WriteRegister(PCD_Register reg, byte value)
+{
+    switch (reg)
+    {
+    case ComIEnReg:
+        _comIEn = value;
+        break;
+    case FIFODataReg:
+        _fifo = value;
+        break;
+    case CommandReg:
+        _command = value;
+        break;
+    case BitFramingReg:
+        if ((value & 0x80) && _command == PCD_Transceive)
+        {
+            transceiveFifo();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void MFRC522::PCD_WriteRegister(PCD_Register reg, byte count, byte *values)
+{
+    for (byte i = 0; i < count; i++)
+    {
+        PCD_WriteRegister(reg, values[i]);
+    }
+}
+
+byte MFRC522::PCD_ReadRegister(PCD_Register reg)
+{
+    switch (reg)
+    {
+    case VersionReg:
+        return 0x92;
+    case ComIEnReg:
+        return _comIEn;
+    case RFCfgReg:
+        return _gain;
+    default:
+        return 0;
+    }
+}
+
+void MFRC522::PCD_ReadRegister(PCD_Register reg, byte count, byte *values, byte rxAlign)
+{
+    for (byte i = 0; i < count; i++)
+    {
+        values[i] = PCD_ReadRegister(reg);
+    }
+}
+
+// Sent by CardDetect with the IRQ armed: the chip times out on its own, so
+// the firmware is not held up whether or not a card answers
+void MFRC522::transceiveFifo()
+{
+    if (_fifo != PICC_CMD_REQA && _fifo != PICC_CMD_WUPA)
+    {
+        return;
+    }
+    fakeCounters.frames++;
+    if (wake(_fifo) > 0 && (_comIEn & 0x20) && fakeIrqPin >= 0)
+    {
+        shimRaiseInterrupt(fakeIrqPin);
+    }
+}
+
+MFRC522::StatusCode MFRC522::PICC_RequestA(byte *bufferATQA, byte *bufferSize)
+{
+    return PICC_REQA_or_WUPA(PICC_CMD_REQA, bufferATQA, bufferSize);
+}
+
+MFRC522::StatusCode MFRC522::PICC_WakeupA(byte *bufferATQA, byte *bufferSize)
+{
+    return PICC_REQA_or_WUPA(PICC_CMD_WUPA, bufferATQA, bufferSize);
+}
+
+// REQA wakes IDLE cards, WUPA also HALTed ones. Any other card that was
+// READY or ACTIVE takes it as an unexpected frame and drops back.
+uint8_t MFRC522::wake(byte command)
+{
+    fakeCounters.requests++;
+    _crypto = false;
+    _authSector = -1;
+
+    uint8_t answered = 0;
+    for (FakeCard *card : _field)
+    {
+        if (card->state == FakeCard::Idle || (command == PICC_CMD_WUPA && card->state == FakeCard::Halt))
+        {
+            card->state = FakeCard::Ready;
+            answered++;
+        }
+        else if (card->state == FakeCard::Ready || card->state == FakeCard::Active)
+        {
+            card->state = FakeCard::Idle;
+        }
+    }
+    return answered;
+}
+
+MFRC522::StatusCode MFRC522::PICC_REQA_or_WUPA(byte command, byte *bufferATQA, byte *bufferSize)
+{
+    if (bufferATQA == nullptr || *bufferSize < 2)
+    {
+        return STATUS_NO_ROOM;
+    }
+    if (wake(command) == 0)
+    {
+        charge(FAKE_TIMEOUT_US);
+        return STATUS_TIMEOUT;
+    }
+    charge(FAKE_FRAME_US);
+    bufferATQA[0] = 0x04;
+    bufferATQA[1] = 0x00;
+    *bufferSize = 2;
+    return STATUS_OK;
+}
+
+static bool uidLess(const MFRC522::Uid &a, const MFRC522::Uid &b)
+{
+    return memcmp(a.uidByte, b.uidByte, min(a.size, b.size)) < 0;
+}
+
+static bool uidEqual(const MFRC522::Uid &a, const MFRC522::Uid &b)
+{
+    return a.size == b.size && memcmp(a.uidByte, b.uidByte, a.size) == 0;
+}
+
+// With validBits 0 anticollision walks the UID bits and ends on the lowest
+// UID in the field; with the full UID given only that card answers. Either
+// way the cards not selected fall back to IDLE.
+MFRC522::StatusCode MFRC522::PICC_Select(Uid *uid, byte validBits)
+{
+    fakeCounters.selects++;
+    FakeCard *chosen = nullptr;
+    for (FakeCard *card : _field)
+    {
+        if (card->state != FakeCard::Ready)
+        {
+            continue;
+        }
+        if (validBits != 0 ? uidEqual(card->uid, *uid) : (chosen == nullptr || uidLess(card->uid, chosen->uid)))
+        {
+            chosen = card;
+        }
+    }
+    if (chosen == nullptr)
+    {
+        charge(FAKE_TIMEOUT_US);
+        return STATUS_TIMEOUT;
+    }
+
+    for (FakeCard *card : _field)
+    {
+        if (card != chosen && card->state == FakeCard::Ready)
+        {
+            card->state = FakeCard::Idle;
+        }
+    }
+    chosen->state = FakeCard::Active;
+    charge(FAKE_SELECT_US * (chosen->uid.size > 4 ? 2 : 1));
+    *uid = chosen->uid;
+    return STATUS_OK;
+}
+
+// The real library sends HLTA and waits out the timeout, since a card that
+// halts does not answer. A card that is not ACTIVE ignores it.
+MFRC522::StatusCode MFRC522::PICC_HaltA()
+{
+    fakeCounters.halts++;
+    FakeCard *card = active();
+    if (card != nullptr)
+    {
+        card->state = FakeCard::Halt;
+    }
+    _crypto = false;
+    _authSector = -1;
+    charge(FAKE_TIMEOUT_US);
+    return STATUS_OK;
+}
+
+FakeCard *MFRC522::active()
+{
+    for (FakeCard *card : _field)
+    {
+        if (card->state == FakeCard::Active)
+        {
+            return card;
+        }
+    }
+    return nullptr;
+}
+
+FakeCard *MFRC522::authenticated(byte blockAddr)
+{
+    FakeCard *card = active();
+    if (card == nullptr)
+    {
+        return nullptr;
+    }
+    if (card->isUltralight())
+    {
+        return card;
+    }
+    return _crypto && _authSector == blockAddr / 4 ? card : nullptr;
+}
+
+void MFRC522::fail(FakeCard *card)
+{
+    if (card != nullptr)
+    {
+        card->state = FakeCard::Idle;
+    }
+    _crypto = false;
+    _authSector = -1;
+    _valueLoaded = false;
+}
+
+MFRC522::StatusCode MFRC522::PCD_Authenticate(byte command, byte blockAddr, MIFARE_Key *key, Uid *uid)
+{
+    fakeCounters.auths++;
+    FakeCard *card = active();
+    if (card == nullptr || card->isUltralight() || !uidEqual(card->uid, *uid))
+    {
+        fail(card);
+        charge(FAKE_TIMEOUT_US);
+        return STATUS_TIMEOUT;
+    }
+
+    const byte *trailer = card->blocks[(blockAddr / 4) * 4 + 3];
+    const byte *cardKey = command == PICC_CMD_MF_AUTH_KEY_A ? trailer : trailer + 10;
+    if (card->failAuths > 0 || memcmp(cardKey, key->keyByte, MF_KEY_SIZE) != 0)
+    {
+        if (card->failAuths > 0)
+        {
+            card->failAuths--;
+        }
+        fail(card);
+        charge(FAKE_TIMEOUT_US);
+        return STATUS_TIMEOUT;
+    }
+    _crypto = true;
+    _authSector = blockAddr / 4;
+    charge(FAKE_AUTH_US);
+    return STATUS_OK;
+}
+
+void MFRC522::PCD_StopCrypto1()
+{
+    _crypto = false;
+    _authSector = -1;
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Read(byte blockAddr, byte *buffer, byte *bufferSize)
+{
+    if (buffer == nullptr || *bufferSize < 18)
+    {
+        return STATUS_NO_ROOM;
+    }
+    fakeCounters.reads++;
+    FakeCard *card = active();
+    if (card != nullptr && card->isUltralight())
+    {
+        // blockAddr is a page; READ returns four pages
+        for (byte i = 0; i < 4; i++)
+        {
+            byte page = blockAddr + i;
+            memcpy(buffer + i * 4, card->blocks[page / 4] + (page % 4) * 4, 4);
+        }
+    }
+    else if ((card = authenticated(blockAddr)) != nullptr)
+    {
+        memcpy(buffer, card->blocks[blockAddr], 16);
+    }
+    if (card == nullptr || card->failReads > 0)
+    {
+        if (card != nullptr)
+        {
+            card->failReads--;
+        }
+        fail(card != nullptr ? card : active());
+        charge(FAKE_TIMEOUT_US);
+        return STATUS_TIMEOUT;
+    }
+    buffer[16] = buffer[17] = 0; // CRC_A, already checked
+    *bufferSize = 18;
+    charge(FAKE_READ_US);
+    return STATUS_OK;
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Write(byte blockAddr, byte *buffer, byte bufferSize)
+{
+    if (buffer == nullptr || bufferSize < 16)
+    {
+        return STATUS_INVALID;
+    }
+    fakeCounters.writes++;
+    FakeCard *card = authenticated(blockAddr);
+    if (card == nullptr || card->failWrites > 0)
+    {
+        if (card != nullptr)
+        {
+            card->failWrites--;
+        }
+        fail(card != nullptr ? card : active());
+        charge(FAKE_TIMEOUT_US);
+        return STATUS_TIMEOUT;
+    }
+    memcpy(card->blocks[blockAddr], buffer, 16);
+    charge(FAKE_WRITE_US);
+    return STATUS_OK;
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Ultralight_Write(byte page, byte *buffer, byte bufferSize)
+{
+    if (buffer == nullptr || bufferSize < 4)
+    {
+        return STATUS_INVALID;
+    }
+    fakeCounters.writes++;
+    FakeCard *card = active();
+    if (card == nullptr || !card->isUltralight() || card->failWrites > 0)
+    {
+        if (card != nullptr && card->failWrites > 0)
+        {
+            card->failWrites--;
+        }
+        fail(card);
+        charge(FAKE_TIMEOUT_US);
+        return STATUS_TIMEOUT;
+    }
+    memcpy(card->blocks[page / 4] + (page % 4) * 4, buffer, 4);
+    charge(FAKE_WRITE_US);
+    return STATUS_OK;
+}
+
+// A value operation on a block not formatted as a value block is NAKed
+static MFRC522::StatusCode loadValue(FakeCard *card, byte blockAddr, int32_t &value)
+{
+    if (!card->isValueBlock(blockAddr))
+    {
+        return MFRC522::STATUS_MIFARE_NACK;
+    }
+    const byte *block = card->blocks[blockAddr];
+    value = (int32_t)((uint32_t)block[0] | ((uint32_t)block[1] << 8) | ((uint32_t)block[2] << 16) |
+                      ((uint32_t)block[3] << 24));
+    return MFRC522::STATUS_OK;
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Increment(byte blockAddr, int32_t delta)
+{
+    fakeCounters.writes++;
+    FakeCard *card = authenticated(blockAddr);
+    int32_t value = 0;
+    StatusCode status = card == nullptr ? STATUS_TIMEOUT : loadValue(card, blockAddr, value);
+    if (status != STATUS_OK || card->failWrites > 0)
+    {
+        if (card != nullptr && card->failWrites > 0)
+        {
+            card->failWrites--;
+            status = STATUS_TIMEOUT;
+        }
+        fail(card != nullptr ? card : active());
+        charge(FAKE_TIMEOUT_US);
+        return status;
+    }
+    _valueRegister = value + delta;
+    _valueLoaded = true;
+    charge(FAKE_VALUE_US);
+    return STATUS_OK;
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Decrement(byte blockAddr, int32_t delta)
+{
+    return MIFARE_Increment(blockAddr, -delta);
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Restore(byte blockAddr)
+{
+    return MIFARE_Increment(blockAddr, 0);
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Transfer(byte blockAddr)
+{
+    fakeCounters.writes++;
+    FakeCard *card = authenticated(blockAddr);
+    if (card == nullptr || !_valueLoaded)
+    {
+        fail(card != nullptr ? card : active());
+        charge(FAKE_TIMEOUT_US);
+        return card == nullptr ? STATUS_TIMEOUT : STATUS_MIFARE_NACK;
+    }
+    card->setValueBlock(blockAddr, _valueRegister);
+    _valueLoaded = false;
+    charge(FAKE_WRITE_US);
+    return STATUS_OK;
+}
+
+// As in the library: the first four bytes of the block, unchecked
+MFRC522::StatusCode MFRC522::MIFARE_GetValue(byte blockAddr, int32_t *value)
+{
+    byte buffer[18];
+    byte size = sizeof(buffer);
+    StatusCode status = MIFARE_Read(blockAddr, buffer, &size);
+    if (status == STATUS_OK)
+    {
+        *value = (int32_t)((uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) |
+                           ((uint32_t)buffer[3] << 24));
+    }
+    return status;
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_SetValue(byte blockAddr, int32_t value)
+{
+    byte buffer[16];
+    for (byte i = 0; i < 4; i++)
+    {
+        buffer[i] = buffer[i + 8] = (value >> (8 * i)) & 0xFF;
+        buffer[i + 4] = ~buffer[i];
+    }
+    buffer[12] = buffer[14] = blockAddr;
+    buffer[13] = buffer[15] = ~blockAddr;
+    return MIFARE_Write(blockAddr, buffer, 16);
+}
+
+bool MFRC522::PICC_IsNewCardPresent()
+{
+    byte atqa[2];
+    byte atqaSize = sizeof(atqa);
+    StatusCode status = PICC_RequestA(atqa, &atqaSize);
+    return status == STATUS_OK || status == STATUS_COLLISION;
+}
+
+bool MFRC522::PICC_ReadCardSerial()
+{
+    return PICC_Select(&uid) == STATUS_OK;
+}
+
+const __FlashStringHelper *MFRC522::GetStatusCodeName(StatusCode code)
+{
+    switch (code)
+    {
+    case STATUS_OK:
+        return F("Success.");
+    case STATUS_ERROR:
+        return F("Error in communication.");
+    case STATUS_COLLISION:
+        return F("Collission detected.");
+    case STATUS_TIMEOUT:
+        return F("Timeout in communication.");
+    case STATUS_NO_ROOM:
+        return F("A buffer is not big enough.");
+    case STATUS_INTERNAL_ERROR:
+        return F("Internal error in the code. Should not happen.");
+    case STATUS_INVALID:
+        return F("Invalid argument.");
+    case STATUS_CRC_WRONG:
+        return F("The CRC_A does not match.");
+    case STATUS_MIFARE_NACK:
+        return F("A MIFARE PICC responded with NAK.");
+    default:
+        return F("Unknown error");
+    }
+}
+
+MFRC522::PICC_Type MFRC522::PICC_GetType(byte sak)
+{
+    sak &= 0x7F;
+    switch (sak)
+    {
+    case 0x04:
+        return PICC_TYPE_NOT_COMPLETE;
+    case 0x09:
+        return PICC_TYPE_MIFARE_MINI;
+    case 0x08:
+        return PICC_TYPE_MIFARE_1K;
+    case 0x18:
+        return PICC_TYPE_MIFARE_4K;
+    case 0x00:
+        return PICC_TYPE_MIFARE_UL;
+    case 0x10:
+    case 0x11:
+        return PICC_TYPE_MIFARE_PLUS;
+    case 0x01:
+        return PICC_TYPE_TNP3XXX;
+    case 0x20:
+        return PICC_TYPE_ISO_14443_4;
+    case 0x40:
+        return PICC_TYPE_ISO_18092;
+    default:
+        return PICC_TYPE_UNKNOWN;
+    }
+}
@@ -0,0 +1,263 @@
+// MFRC522.h
+// Stand-in for the MFRC522 library: the same class and signatures, backed
+// by simulated cards instead of SPI. Cards follow the ISO 14443-3 states
+// (IDLE, READY, ACTIVE, HALT), so REQA, WUPA, select and HLTA behave as they
+// do on a real field, and MIFARE Classic sectors need Crypto1 auth first.
+//
+// Every frame advances the shim clock by what it takes on air at 106 kbit/s
+// plus the reader's timeout where the real library waits one out, so
+// simulated taps take realistic time without running in real time.
+#ifndef MFRC522_H
+#define MFRC522_H
+
+#include "Arduino.h"
+#include <vector>
+
+// Time one frame costs, in microseconds
+#define FAKE_FRAME_US 250       // short command and answer: REQA, WUPA, SAK
+#define FAKE_SELECT_US 1200     // anticollision and select, one cascade level
+#define FAKE_AUTH_US 2000       // three-pass Crypto1 authentication
+#define FAKE_READ_US 1500       // READ: 16 bytes and CRC back
+#define FAKE_WRITE_US 6000      // two-phase WRITE including the EEPROM cycle
+#define FAKE_VALUE_US 3000      // INCREMENT/DECREMENT into the value register
+#define FAKE_TIMEOUT_US 25000   // no answer: PCD_Init sets a 25 ms timer
+
+class FakeCard;
+
+class MFRC522
+{
+public:
+    enum PCD_Register : byte
+    {
+        CommandReg = 0x01 << 1,
+        ComIEnReg = 0x02 << 1,
+        DivIEnReg = 0x03 << 1,
+        ComIrqReg = 0x04 << 1,
+        DivIrqReg = 0x05 << 1,
+        ErrorReg = 0x06 << 1,
+        Status1Reg = 0x07 << 1,
+        Status2Reg = 0x08 << 1,
+        FIFODataReg = 0x09 << 1,
+        FIFOLevelReg = 0x0A << 1,
+        ControlReg = 0x0C << 1,
+        BitFramingReg = 0x0D << 1,
+        CollReg = 0x0E << 1,
+        ModeReg = 0x11 << 1,
+        TxModeReg = 0x12 << 1,
+        RxModeReg = 0x13 << 1,
+        TxControlReg = 0x14 << 1,
+        TxASKReg = 0x15 << 1,
+        RFCfgReg = 0x26 << 1,
+        TModeReg = 0x2A << 1,
+        TPrescalerReg = 0x2B << 1,
+        AutoTestReg = 0x36 << 1,
+        VersionReg = 0x37 << 1
+    };
+
+    enum PCD_Command : byte
+    {
+        PCD_Idle = 0x00,
+        PCD_Mem = 0x01,
+        PCD_GenerateRandomID = 0x02,
+        PCD_CalcCRC = 0x03,
+        PCD_Transmit = 0x04,
+        PCD_NoCmdChange = 0x07,
+        PCD_Receive = 0x08,
+        PCD_Transceive = 0x0C,
+        PCD_MFAuthent = 0x0E,
+        PCD_SoftReset = 0x0F
+    };
+
+    enum PCD_RxGain : byte
+    {
+        RxGain_18dB = 0x00 << 4,
+        RxGain_23dB = 0x01 << 4,
+        RxGain_33dB = 0x04 << 4,
+        RxGain_38dB = 0x05 << 4,
+        RxGain_43dB = 0x06 << 4,
+        RxGain_48dB = 0x07 << 4,
+        RxGain_min = 0x00 << 4,
+        RxGain_avg = 0x04 << 4,
+        RxGain_max = 0x07 << 4
+    };
+
+    enum PICC_Command : byte
+    {
+        PICC_CMD_REQA = 0x26,
+        PICC_CMD_WUPA = 0x52,
+        PICC_CMD_CT = 0x88,
+        PICC_CMD_SEL_CL1 = 0x93,
+        PICC_CMD_SEL_CL2 = 0x95,
+        PICC_CMD_SEL_CL3 = 0x97,
+        PICC_CMD_HLTA = 0x50,
+        PICC_CMD_MF_AUTH_KEY_A = 0x60,
+        PICC_CMD_MF_AUTH_KEY_B = 0x61,
+        PICC_CMD_MF_READ = 0x30,
+        PICC_CMD_MF_WRITE = 0xA0,
+        PICC_CMD_MF_DECREMENT = 0xC0,
+        PICC_CMD_MF_INCREMENT = 0xC1,
+        PICC_CMD_MF_RESTORE = 0xC2,
+        PICC_CMD_MF_TRANSFER = 0xB0,
+        PICC_CMD_UL_WRITE = 0xA2
+    };
+
+    enum MIFARE_Misc
+    {
+        MF_ACK = 0xA,
+        MF_KEY_SIZE = 6
+    };
+
+    enum PICC_Type : byte
+    {
+        PICC_TYPE_UNKNOWN,
+        PICC_TYPE_ISO_14443_4,
+        PICC_TYPE_ISO_18092,
+        PICC_TYPE_MIFARE_MINI,
+        PICC_TYPE_MIFARE_1K,
+        PICC_TYPE_MIFARE_4K,
+        PICC_TYPE_MIFARE_UL,
+        PICC_TYPE_MIFARE_PLUS,
+        PICC_TYPE_MIFARE_DESFIRE,
+        PICC_TYPE_TNP3XXX,
+        PICC_TYPE_NOT_COMPLETE = 0xff
+    };
+
+    enum StatusCode : byte
+    {
+        STATUS_OK,
+        STATUS_ERROR,
+        STATUS_COLLISION,
+        STATUS_TIMEOUT,
+        STATUS_NO_ROOM,
+        STATUS_INTERNAL_ERROR,
+        STATUS_INVALID,
+        STATUS_CRC_WRONG,
+        STATUS_MIFARE_NACK = 0xff
+    };
+
+    typedef struct
+    {
+        byte size;
+        byte uidByte[10];
+        byte sak;
+    } Uid;
+
+    typedef struct
+    {
+        byte keyByte[MF_KEY_SIZE];
+    } MIFARE_Key;
+
+    // What the reader sent, for tests to assert on
+    struct FakeCounters
+    {
+        uint32_t requests; // REQA and WUPA
+        uint32_t selects;
+        uint32_t auths;
+        uint32_t reads;
+        uint32_t writes;   // WRITE, value operations and TRANSFER
+        uint32_t halts;
+        uint32_t frames;   // everything sent to the field
+    };
+
+    Uid uid;
+
+    MFRC522();
+    MFRC522(byte resetPowerDownPin);
+    MFRC522(byte chipSelectPin, byte resetPowerDownPin);
+
+    void PCD_WriteRegister(PCD_Register reg, byte value);
+    void PCD_WriteRegister(PCD_Register reg, byte count, byte *values);
+    byte PCD_ReadRegister(PCD_Register reg);
+    void PCD_ReadRegister(PCD_Register reg, byte count, byte *values, byte rxAlign = 0);
+
+    void PCD_Init() {}
+    void PCD_Init(byte resetPowerDownPin) {}
+    void PCD_Init(byte chipSelectPin, byte resetPowerDownPin) {}
+    void PCD_Reset() {}
+    void PCD_SetAntennaGain(byte mask) { _gain = mask; }
+    byte PCD_GetAntennaGain() { return _gain; }
+    bool PCD_PerformSelfTest() { return true; }
+
+    StatusCode PICC_RequestA(byte *bufferATQA, byte *bufferSize);
+    StatusCode PICC_WakeupA(byte *bufferATQA, byte *bufferSize);
+    StatusCode PICC_REQA_or_WUPA(byte command, byte *bufferATQA, byte *bufferSize);
+    StatusCode PICC_Select(Uid *uid, byte validBits = 0);
+    StatusCode PICC_HaltA();
+
+    StatusCode PCD_Authenticate(byte command, byte blockAddr, MIFARE_Key *key, Uid *uid);
+    void PCD_StopCrypto1();
+    StatusCode MIFARE_Read(byte blockAddr, byte *buffer, byte *bufferSize);
+    StatusCode MIFARE_Write(byte blockAddr, byte *buffer, byte bufferSize);
+    StatusCode MIFARE_Ultralight_Write(byte page, byte *buffer, byte bufferSize);
+    StatusCode MIFARE_Decrement(byte blockAddr, int32_t delta);
+    StatusCode MIFARE_Increment(byte blockAddr, int32_t delta);
+    StatusCode MIFARE_Restore(byte blockAddr);
+    StatusCode MIFARE_Transfer(byte blockAddr);
+    StatusCode MIFARE_GetValue(byte blockAddr, int32_t *value);
+    StatusCode MIFARE_SetValue(byte blockAddr, int32_t value);
+
+    static const __FlashStringHelper *GetStatusCodeName(StatusCode code);
+    static PICC_Type PICC_GetType(byte sak);
+
+    bool PICC_IsNewCardPresent();
+    bool PICC_ReadCardSerial();
+
+    // Test controls
+    void fakeInsert(FakeCard &card); // card enters the field, powered up in IDLE
+    void fakeRemove(FakeCard &card);
+    void fakeClearField();
+    FakeCounters fakeCounters;
+    int fakeIrqPin; // pin the IRQ line is wired to, -1 for none
+
+private:
+    void charge(uint32_t us);
+    FakeCard *active();
+    FakeCard *authenticated(byte blockAddr);
+    void fail(FakeCard *card);
+    void transceiveFifo();
+    uint8_t wake(byte command);
+
+    std::vector<FakeCard *> _field;
+    byte _gain;
+    byte _comIEn;
+    byte _fifo;
+    byte _command;
+    bool _crypto;
+    int _authSector;
+    bool _valueLoaded; // INCREMENT/DECREMENT/RESTORE left a value to TRANSFER
+    int32_t _valueRegister;
+};
+
+// A card for the fake field. MIFARE Classic 1K by default (SAK 0x08), with
+// every sector trailer holding the transport key FF..FF. SAK 0x00 makes it
+// an Ultralight, addressed by 4-byte page.
+class FakeCard
+{
+public:
+    enum State
+    {
+        Idle,
+        Ready,
+        Active,
+        Halt
+    };
+
+    FakeCard(uint32_t uidValue, byte sak = 0x08);
+
+    bool isUltralight() const { return MFRC522::PICC_GetType(uid.sak) == MFRC522::PICC_TYPE_MIFARE_UL; }
+    void setValueBlock(byte blockAddr, int32_t value); // format as a MIFARE value block
+    bool isValueBlock(byte blockAddr) const;
+
+    MFRC522::Uid uid;
+    byte blocks[64][16];
+    State state;
+    bool inField;
+
+    // Injected faults: each one makes the next matching frame fail once,
+    // with the card dropping to IDLE as a real card does on an error
+    uint8_t failAuths;
+    uint8_t failReads;
+    uint8_t failWrites;
+};
+
+#endif // MFRC522_H
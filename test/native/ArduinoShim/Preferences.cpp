@@ -0,0 +1,72 @@
+#include "Preferences.h"
+#include <map>
+#include <string>
+
+static std::map<std::string, uint32_t> store;
+
+static std::string storeKey(const String &name, const char *key)
+{
+    return std::string(name.c_str()) + "/" + key;
+}
+
+void shimClearPreferences()
+{
+    store.clear();
+}
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    _name = name;
+    _open = true;
+    _readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end()
+{
+    _open = false;
+}
+
+uint32_t Preferences::get(const char *key, uint32_t defaultValue)
+{
+    if (!_open)
+    {
+        return defaultValue;
+    }
+    auto found = store.find(storeKey(_name, key));
+    return found == store.end() ? defaultValue : found->second;
+}
+
+size_t Preferences::put(const char *key, uint32_t value, size_t size)
+{
+    if (!_open || _readOnly)
+    {
+        return 0;
+    }
+    store[storeKey(_name, key)] = value;
+    return size;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return _open && store.count(storeKey(_name, key)) > 0;
+}
+
+bool Preferences::remove(const char *key)
+{
+    return _open && !_readOnly && store.erase(storeKey(_name, key)) > 0;
+}
+
+bool Preferences::clear()
+{
+    if (!_open || _readOnly)
+    {
+        return false;
+    }
+    std::string prefix = storeKey(_name, "");
+    for (auto it = store.begin(); it != store.end();)
+    {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? store.erase(it) : std::next(it);
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+// Preferences.h
+// NVS as an in-memory map that lives as long as the test process, so a
+// value put by one Preferences object is read back by the next.
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include "Arduino.h"
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false);
+    void end();
+
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putUChar(const char *key, uint8_t value) { return put(key, value, 1); }
+    uint16_t getUShort(const char *key, uint16_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putUShort(const char *key, uint16_t value) { return put(key, value, 2); }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return get(key, defaultValue); }
+    size_t putUInt(const char *key, uint32_t value) { return put(key, value, 4); }
+    int32_t getInt(const char *key, int32_t defaultValue = 0) { return (int32_t)get(key, (uint32_t)defaultValue); }
+    size_t putInt(const char *key, int32_t value) { return put(key, (uint32_t)value, 4); }
+    bool getBool(const char *key, bool defaultValue = false) { return get(key, defaultValue) != 0; }
+    size_t putBool(const char *key, bool value) { return put(key, value, 1); }
+
+    bool isKey(const char *key);
+    bool remove(const char *key);
+    bool clear();
+
+private:
+    uint32_t get(const char *key, uint32_t defaultValue);
+    size_t put(const char *key, uint32_t value, size_t size);
+
+    String _name;
+    bool _open = false;
+    bool _readOnly = false;
+};
+
+void shimClearPreferences(); // forget every namespace, as a fresh flash would
+
+#endif // PREFERENCES_H
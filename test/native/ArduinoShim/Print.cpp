@@ -0,0 +1,62 @@
+#include "Print.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (size--)
+    {
+        if (write(*buffer++) == 0)
+        {
+            break;
+        }
+        written++;
+    }
+    return written;
+}
+
+size_t Print::write(const char *text)
+{
+    return text ? write((const uint8_t *)text, strlen(text)) : 0;
+}
+
+size_t Print::print(long value, int base)
+{
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(long long value, int base)
+{
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long long value, int base)
+{
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int digits)
+{
+    return print(String(value, (unsigned int)digits));
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0)
+    {
+        return 0;
+    }
+    return write((const uint8_t *)text, (size_t)length < sizeof(text) ? length : sizeof(text) - 1);
+}
@@ -0,0 +1,28 @@
+// SPI.h
+// The MFRC522 fake talks to no bus; SPI only has to exist.
+#ifndef SPI_H
+#define SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings
+{
+public:
+    SPISettings() {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+class SPIClass
+{
+public:
+    void begin(int sck = -1, int miso = -1, int mosi = -1, int ss = -1) {}
+    void beginTransaction(SPISettings settings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data) { return 0; }
+};
+extern SPIClass SPI;
+
+#endif // SPI_H
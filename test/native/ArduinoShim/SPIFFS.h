@@ -0,0 +1,16 @@
+// SPIFFS.h
+#ifndef SPIFFS_H
+#define SPIFFS_H
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS
+{
+public:
+    bool begin(bool formatOnFail = false) { return true; }
+    size_t totalBytes() { return 1441792; }
+    size_t usedBytes();
+};
+extern SPIFFSFS SPIFFS;
+
+#endif // SPIFFS_H
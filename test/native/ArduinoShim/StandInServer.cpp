@@ -0,0 +1,172 @@
+#include "StandInServer.h"
+#include "WiFi.h"
+#include <netinet/in.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+
+bool StandInServer::start(uint16_t firmwarePort, Handler handler)
+{
+    _handler = handler;
+    _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(_listenFd, (sockaddr *)&address, sizeof(address)) != 0 || listen(_listenFd, 8) != 0 ||
+        getsockname(_listenFd, (sockaddr *)&address, &length) != 0)
+    {
+        close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+    _port = ntohs(address.sin_port);
+    shimRedirectPort(firmwarePort, _port);
+    _running = true;
+    _acceptThread = std::thread(&StandInServer::acceptLoop, this);
+    return true;
+}
+
+void StandInServer::stop()
+{
+    if (!_running)
+    {
+        return;
+    }
+    _running = false;
+    shutdown(_listenFd, SHUT_RDWR);
+    _acceptThread.join();
+    close(_listenFd);
+    _listenFd = -1;
+
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> hold(_lock);
+        for (int fd : _open)
+        {
+            shutdown(fd, SHUT_RDWR);
+        }
+        workers.swap(_workers);
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+std::vector<StandInRequest> StandInServer::received()
+{
+    std::lock_guard<std::mutex> hold(_lock);
+    return _received;
+}
+
+void StandInServer::acceptLoop()
+{
+    while (_running)
+    {
+        int fd = accept(_listenFd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+        _connections++;
+        std::lock_guard<std::mutex> hold(_lock);
+        _open.push_back(fd);
+        _workers.emplace_back(&StandInServer::serve, this, fd);
+    }
+}
+
+static bool readLine(int fd, std::string &line)
+{
+    line.clear();
+    char c;
+    while (recv(fd, &c, 1, 0) == 1)
+    {
+        if (c == '\n')
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            return true;
+        }
+        line += c;
+    }
+    return false;
+}
+
+static std::string headerValue(const std::string &line, const char *name)
+{
+    size_t length = strlen(name);
+    if (line.size() <= length || strncasecmp(line.c_str(), name, length) != 0 || line[length] != ':')
+    {
+        return "";
+    }
+    size_t start = line.find_first_not_of(' ', length + 1);
+    return start == std::string::npos ? "" : line.substr(start);
+}
+
+void StandInServer::serve(int fd)
+{
+    std::string line;
+    while (_running && readLine(fd, line))
+    {
+        StandInRequest request;
+        size_t space = line.find(' ');
+        request.method = line.substr(0, space);
+        request.path = line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+
+        size_t contentLength = 0;
+        while (readLine(fd, line) && !line.empty())
+        {
+            std::string value = headerValue(line, "Content-Length");
+            if (!value.empty())
+            {
+                contentLength = strtoul(value.c_str(), nullptr, 10);
+            }
+            value = headerValue(line, "Idempotency-Key");
+            if (!value.empty())
+            {
+                request.idempotencyKey = value;
+            }
+        }
+        request.body.resize(contentLength);
+        size_t got = 0;
+        while (got < contentLength)
+        {
+            ssize_t n = recv(fd, &request.body[got], contentLength - got, 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            got += n;
+        }
+
+        StandInResponse response;
+        _handler(request, response);
+        _requests++;
+        {
+            std::lock_guard<std::mutex> hold(_lock);
+            _received.push_back(request);
+        }
+
+        std::string reply = "HTTP/1.1 " + std::to_string(response.status) + " OK\r\n" +
+                            "Content-Type: application/json\r\n" +
+                            "Content-Length: " + std::to_string(response.body.size()) + "\r\n" +
+                            (response.close ? "Connection: close\r\n" : "Connection: keep-alive\r\n") + "\r\n" +
+                            response.body;
+        send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+        if (response.close)
+        {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> hold(_lock);
+    _open.erase(std::remove(_open.begin(), _open.end(), fd), _open.end());
+    close(fd);
+}
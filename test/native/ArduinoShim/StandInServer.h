@@ -0,0 +1,62 @@
+// StandInServer.h
+// A small HTTP/1.1 server on localhost for tests that exercise the game API
+// client over real sockets. Connections are kept alive unless the handler
+// asks to close, and the server counts what it accepted and answered.
+#ifndef STANDINSERVER_H
+#define STANDINSERVER_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct StandInRequest
+{
+    std::string method;
+    std::string path;
+    std::string body;
+    std::string idempotencyKey;
+};
+
+struct StandInResponse
+{
+    int status = 200;
+    std::string body;
+    bool close = false; // answer with Connection: close and hang up
+};
+
+class StandInServer
+{
+public:
+    typedef std::function<void(const StandInRequest &, StandInResponse &)> Handler;
+
+    // Listens on an ephemeral port and redirects connects to firmwarePort there
+    bool start(uint16_t firmwarePort, Handler handler);
+    void stop();
+    ~StandInServer() { stop(); }
+
+    uint16_t port() const { return _port; }
+    uint32_t connections() const { return _connections; }
+    uint32_t requests() const { return _requests; }
+    std::vector<StandInRequest> received();
+
+private:
+    void acceptLoop();
+    void serve(int fd);
+
+    Handler _handler;
+    int _listenFd = -1;
+    uint16_t _port = 0;
+    std::atomic<bool> _running{false};
+    std::atomic<uint32_t> _connections{0};
+    std::atomic<uint32_t> _requests{0};
+    std::thread _acceptThread;
+    std::mutex _lock;
+    std::vector<std::thread> _workers;
+    std::vector<int> _open;
+    std::vector<StandInRequest> _received;
+};
+
+#endif // STANDINSERVER_H
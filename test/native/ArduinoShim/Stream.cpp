@@ -0,0 +1,88 @@
+#include "Arduino.h"
+
+int Stream::timedRead()
+{
+    unsigned long start = millis();
+    do
+    {
+        int c = read();
+        if (c >= 0)
+        {
+            return c;
+        }
+        yield();
+    } while (millis() - start < _timeout);
+    return -1;
+}
+
+int Stream::timedPeek()
+{
+    unsigned long start = millis();
+    do
+    {
+        int c = peek();
+        if (c >= 0)
+        {
+            return c;
+        }
+        yield();
+    } while (millis() - start < _timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length)
+    {
+        int c = timedRead();
+        if (c < 0)
+        {
+            break;
+        }
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readString()
+{
+    String text;
+    int c;
+    while ((c = timedRead()) >= 0)
+    {
+        text += (char)c;
+    }
+    return text;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+    String text;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator)
+    {
+        text += (char)c;
+    }
+    return text;
+}
+
+bool Stream::find(const char *target)
+{
+    size_t length = strlen(target);
+    size_t matched = 0;
+    if (length == 0)
+    {
+        return true;
+    }
+    int c;
+    while ((c = timedRead()) >= 0)
+    {
+        matched = (c == target[matched]) ? matched + 1 : (c == target[0] ? 1 : 0);
+        if (matched == length)
+        {
+            return true;
+        }
+    }
+    return false;
+}
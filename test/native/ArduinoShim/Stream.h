@@ -0,0 +1,33 @@
+// Stream.h
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+// Arduino's Stream: reads that wait up to the stream timeout for each byte
+class Stream : public Print
+{
+public:
+    Stream() : _timeout(1000) {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs) { _timeout = timeoutMs; }
+    unsigned long getTimeout() const { return _timeout; }
+
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    String readString();
+    String readStringUntil(char terminator);
+    bool find(const char *target);
+
+protected:
+    int timedRead();
+    int timedPeek();
+
+    unsigned long _timeout;
+};
+
+#endif // STREAM_H
@@ -0,0 +1,40 @@
+// TFT_eSPI.h
+// A display that draws nothing. Text sent to it is dropped like Serial's.
+#ifndef TFT_ESPI_H
+#define TFT_ESPI_H
+
+#include "Arduino.h"
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_YELLOW 0xFFE0
+#define MC_DATUM 4
+
+class TFT_eSPI : public Print
+{
+public:
+    using Print::write;
+    void init() {}
+    void setRotation(uint8_t rotation) {}
+    void fillScreen(uint32_t color) {}
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {}
+    void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {}
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {}
+    void setCursor(int16_t x, int16_t y) { _cursorY = y; }
+    int16_t getCursorY() { return _cursorY; }
+    void setTextSize(uint8_t size) {}
+    void setTextColor(uint16_t color) {}
+    void setTextColor(uint16_t color, uint16_t background) {}
+    void setTextDatum(uint8_t datum) {}
+    int16_t drawString(const String &text, int32_t x, int32_t y) { return 0; }
+    int16_t width() { return 240; }
+    int16_t height() { return 135; }
+    size_t write(uint8_t c) override { return 1; }
+
+private:
+    int16_t _cursorY = 0;
+};
+
+#endif // TFT_ESPI_H
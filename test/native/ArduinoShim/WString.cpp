@@ -0,0 +1,330 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::string formatInteger(unsigned long long magnitude, bool negative, unsigned char base)
+{
+    if (base < 2 || base > 36)
+    {
+        base = 10;
+    }
+    char digits[72];
+    int at = sizeof(digits) - 1;
+    digits[at] = '\0';
+    do
+    {
+        int digit = magnitude % base;
+        digits[--at] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        magnitude /= base;
+    } while (magnitude > 0);
+    if (negative)
+    {
+        digits[--at] = '-';
+    }
+    return std::string(digits + at);
+}
+
+// Arduino prints negative numbers in other bases as their two's complement
+String::String(int value, unsigned char base)
+    : _s(base == 10 ? formatInteger(value < 0 ? -(long long)value : value, value < 0, 10)
+                    : formatInteger((unsigned int)value, false, base))
+{
+}
+
+String::String(unsigned int value, unsigned char base) : _s(formatInteger(value, false, base))
+{
+}
+
+String::String(long value, unsigned char base)
+    : _s(base == 10 ? formatInteger(value < 0 ? -(unsigned long long)value : value, value < 0, 10)
+                    : formatInteger((unsigned long)value, false, base))
+{
+}
+
+String::String(unsigned long value, unsigned char base) : _s(formatInteger(value, false, base))
+{
+}
+
+String::String(long long value, unsigned char base)
+    : _s(base == 10 ? formatInteger(value < 0 ? -(unsigned long long)value : value, value < 0, 10)
+                    : formatInteger((unsigned long long)value, false, base))
+{
+}
+
+String::String(unsigned long long value, unsigned char base) : _s(formatInteger(value, false, base))
+{
+}
+
+String::String(double value, unsigned int decimals)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+    _s = text;
+}
+
+bool String::reserve(unsigned int size)
+{
+    _s.reserve(size);
+    return true;
+}
+
+bool String::concat(const String &other)
+{
+    _s += other._s;
+    return true;
+}
+
+bool String::concat(const char *text)
+{
+    if (text == nullptr)
+    {
+        return false;
+    }
+    _s += text;
+    return true;
+}
+
+bool String::concat(const char *text, unsigned int length)
+{
+    if (text == nullptr)
+    {
+        return false;
+    }
+    _s.append(text, length);
+    return true;
+}
+
+bool String::concat(char c)
+{
+    _s += c;
+    return true;
+}
+
+char String::charAt(unsigned int index) const
+{
+    return index < _s.size() ? _s[index] : '\0';
+}
+
+char &String::operator[](unsigned int index)
+{
+    static char dummy;
+    if (index >= _s.size())
+    {
+        dummy = '\0';
+        return dummy;
+    }
+    return _s[index];
+}
+
+void String::setCharAt(unsigned int index, char c)
+{
+    if (index < _s.size())
+    {
+        _s[index] = c;
+    }
+}
+
+void String::getBytes(unsigned char *buffer, unsigned int size, unsigned int index) const
+{
+    if (size == 0 || buffer == nullptr)
+    {
+        return;
+    }
+    if (index >= _s.size())
+    {
+        buffer[0] = '\0';
+        return;
+    }
+    size_t n = _s.copy((char *)buffer, size - 1, index);
+    buffer[n] = '\0';
+}
+
+void String::toCharArray(char *buffer, unsigned int size, unsigned int index) const
+{
+    getBytes((unsigned char *)buffer, size, index);
+}
+
+bool String::equalsIgnoreCase(const String &other) const
+{
+    if (_s.size() != other._s.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < _s.size(); i++)
+    {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)other._s[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool String::startsWith(const String &prefix) const
+{
+    return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const
+{
+    return offset <= _s.size() && _s.compare(offset, prefix._s.size(), prefix._s) == 0;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+    return _s.size() >= suffix._s.size() &&
+           _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const
+{
+    size_t at = _s.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::indexOf(const String &text, unsigned int from) const
+{
+    size_t at = _s.find(text._s, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::lastIndexOf(char c) const
+{
+    size_t at = _s.rfind(c);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::lastIndexOf(const String &text) const
+{
+    size_t at = _s.rfind(text._s);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+String String::substring(unsigned int from) const
+{
+    return from >= _s.size() ? String() : String(_s.substr(from));
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+    if (from > to)
+    {
+        unsigned int swap = from;
+        from = to;
+        to = swap;
+    }
+    return from >= _s.size() ? String() : String(_s.substr(from, to - from));
+}
+
+void String::replace(char find, char with)
+{
+    for (char &c : _s)
+    {
+        if (c == find)
+        {
+            c = with;
+        }
+    }
+}
+
+void String::replace(const String &find, const String &with)
+{
+    if (find._s.empty())
+    {
+        return;
+    }
+    size_t at = 0;
+    while ((at = _s.find(find._s, at)) != std::string::npos)
+    {
+        _s.replace(at, find._s.size(), with._s);
+        at += with._s.size();
+    }
+}
+
+void String::remove(unsigned int index)
+{
+    if (index < _s.size())
+    {
+        _s.erase(index);
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+    if (index < _s.size())
+    {
+        _s.erase(index, count);
+    }
+}
+
+void String::toLowerCase()
+{
+    for (char &c : _s)
+    {
+        c = tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase()
+{
+    for (char &c : _s)
+    {
+        c = toupper((unsigned char)c);
+    }
+}
+
+void String::trim()
+{
+    size_t first = _s.find_first_not_of(" \t\r\n\f\v");
+    if (first == std::string::npos)
+    {
+        _s.clear();
+        return;
+    }
+    size_t last = _s.find_last_not_of(" \t\r\n\f\v");
+    _s = _s.substr(first, last - first + 1);
+}
+
+long String::toInt() const
+{
+    return atol(_s.c_str());
+}
+
+float String::toFloat() const
+{
+    return (float)toDouble();
+}
+
+double String::toDouble() const
+{
+    return atof(_s.c_str());
+}
+
+String operator+(const String &a, const String &b)
+{
+    String sum(a);
+    sum.concat(b);
+    return sum;
+}
+
+String operator+(const String &a, const char *b)
+{
+    String sum(a);
+    sum.concat(b);
+    return sum;
+}
+
+String operator+(const char *a, const String &b)
+{
+    String sum(a);
+    sum.concat(b);
+    return sum;
+}
+
+String operator+(const String &a, char b)
+{
+    String sum(a);
+    sum.concat(b);
+    return sum;
+}
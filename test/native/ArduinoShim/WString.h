@@ -0,0 +1,101 @@
+// WString.h
+// The Arduino String the firmware uses, on std::string. Only the members
+// the firmware, ArduinoJson and ArduinoHttpClient call are here.
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stdint.h>
+#include <string>
+
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper *>(text))
+
+class String
+{
+public:
+    String() {}
+    String(const char *text) : _s(text ? text : "") {}
+    String(const __FlashStringHelper *text) : String(reinterpret_cast<const char *>(text)) {}
+    String(const std::string &text) : _s(text) {}
+    explicit String(char c) : _s(1, c) {}
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(long long value, unsigned char base = 10);
+    String(unsigned long long value, unsigned char base = 10);
+    String(unsigned char value, unsigned char base = 10) : String((unsigned int)value, base) {}
+    String(float value, unsigned int decimals = 2) : String((double)value, decimals) {}
+    String(double value, unsigned int decimals = 2);
+
+    unsigned int length() const { return _s.size(); }
+    const char *c_str() const { return _s.c_str(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int size);
+
+    bool concat(const String &other);
+    bool concat(const char *text);
+    bool concat(const char *text, unsigned int length);
+    bool concat(char c);
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String &operator+=(const T &value)
+    {
+        concat(value);
+        return *this;
+    }
+
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const { return charAt(index); }
+    char &operator[](unsigned int index);
+    void setCharAt(unsigned int index, char c);
+    void toCharArray(char *buffer, unsigned int size, unsigned int index = 0) const;
+    void getBytes(unsigned char *buffer, unsigned int size, unsigned int index = 0) const;
+
+    int compareTo(const String &other) const { return _s.compare(other._s); }
+    bool equals(const String &other) const { return _s == other._s; }
+    bool equals(const char *text) const { return _s == (text ? text : ""); }
+    bool equalsIgnoreCase(const String &other) const;
+    bool startsWith(const String &prefix) const;
+    bool startsWith(const String &prefix, unsigned int offset) const;
+    bool endsWith(const String &suffix) const;
+    bool operator==(const String &other) const { return equals(other); }
+    bool operator==(const char *text) const { return equals(text); }
+    bool operator!=(const String &other) const { return !equals(other); }
+    bool operator!=(const char *text) const { return !equals(text); }
+    bool operator<(const String &other) const { return compareTo(other) < 0; }
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String &text, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String &text) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(char find, char with);
+    void replace(const String &find, const String &with);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+private:
+    std::string _s;
+};
+
+String operator+(const String &a, const String &b);
+String operator+(const String &a, const char *b);
+String operator+(const char *a, const String &b);
+String operator+(const String &a, char b);
+
+#endif // WSTRING_H
@@ -0,0 +1,181 @@
+#include "WiFi.h"
+#include <errno.h>
+#include <map>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+static std::map<uint16_t, uint16_t> redirects;
+static uint32_t connectDelayMs = 0;
+static uint32_t dnsLookups = 0;
+static uint32_t connects = 0;
+
+void shimRedirectPort(uint16_t port, uint16_t to)
+{
+    redirects[port] = to;
+}
+
+void shimSetConnectDelayMs(uint32_t ms)
+{
+    connectDelayMs = ms;
+}
+
+uint32_t shimDnsLookups()
+{
+    return dnsLookups;
+}
+
+uint32_t shimConnects()
+{
+    return connects;
+}
+
+int WiFiClass::hostByName(const char *host, IPAddress &address)
+{
+    dnsLookups++;
+    address = IPAddress(127, 0, 0, 1);
+    return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+    stop();
+    auto redirect = redirects.find(port);
+    sockaddr_in server = {};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(redirect == redirects.end() ? port : redirect->second);
+    server.sin_addr.s_addr = (uint32_t)ip; // already in network order
+
+    connects++;
+    delay(connectDelayMs);
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0 || ::connect(_fd, (sockaddr *)&server, sizeof(server)) != 0)
+    {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+    IPAddress address;
+    return WiFi.hostByName(host, address) == 1 ? connect(address, port) : 0;
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+    if (_fd < 0)
+    {
+        return 0;
+    }
+    ssize_t sent = send(_fd, buffer, size, MSG_NOSIGNAL);
+    return sent < 0 ? 0 : (size_t)sent;
+}
+
+// Reads one byte ahead into _peeked if one has arrived
+bool WiFiClient::fill()
+{
+    if (_peeked >= 0)
+    {
+        return true;
+    }
+    if (_fd < 0)
+    {
+        return false;
+    }
+    uint8_t c;
+    ssize_t got = recv(_fd, &c, 1, MSG_DONTWAIT);
+    if (got == 1)
+    {
+        _peeked = c;
+        return true;
+    }
+    if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        stop(); // closed by the peer
+    }
+    return false;
+}
+
+int WiFiClient::available()
+{
+    if (!fill())
+    {
+        return 0;
+    }
+    char buffer[4096];
+    ssize_t queued = recv(_fd, buffer, sizeof(buffer), MSG_DONTWAIT | MSG_PEEK);
+    return 1 + (queued > 0 ? (int)queued : 0);
+}
+
+int WiFiClient::read()
+{
+    if (!fill())
+    {
+        return -1;
+    }
+    int c = _peeked;
+    _peeked = -1;
+    return c;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+    size_t count = 0;
+    while (count < size)
+    {
+        int c = read();
+        if (c < 0)
+        {
+            break;
+        }
+        buffer[count++] = (uint8_t)c;
+    }
+    return count > 0 ? (int)count : -1;
+}
+
+int WiFiClient::peek()
+{
+    return fill() ? _peeked : -1;
+}
+
+void WiFiClient::stop()
+{
+    if (_fd >= 0)
+    {
+        close(_fd);
+        _fd = -1;
+    }
+    _peeked = -1;
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (_peeked >= 0)
+    {
+        return 1;
+    }
+    if (_fd < 0)
+    {
+        return 0;
+    }
+    // A peer that closed reads as end of stream; the socket is otherwise live
+    uint8_t c;
+    ssize_t got = recv(_fd, &c, 1, MSG_DONTWAIT | MSG_PEEK);
+    if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+int WiFiClient::setNoDelay(bool noDelay)
+{
+    int flag = noDelay ? 1 : 0;
+    return _fd >= 0 && setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) == 0;
+}
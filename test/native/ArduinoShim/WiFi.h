@@ -0,0 +1,65 @@
+// WiFi.h
+// WiFiClient is a real TCP socket, so HTTP code runs against a server on
+// localhost. Every host name resolves to 127.0.0.1, and a test maps the
+// firmware's port onto the port its server listens on.
+#ifndef WIFI_H
+#define WIFI_H
+
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+class WiFiClient : public Client
+{
+public:
+    WiFiClient() : _fd(-1), _peeked(-1) {}
+    ~WiFiClient() { stop(); }
+    WiFiClient(const WiFiClient &) = delete;
+    WiFiClient &operator=(const WiFiClient &) = delete;
+
+    using Print::write;
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return _fd >= 0; }
+    int setNoDelay(bool noDelay);
+
+private:
+    bool fill();
+
+    int _fd;
+    int _peeked; // one byte read ahead by available() or peek(), or -1
+};
+
+class WiFiClass
+{
+public:
+    void begin(const char *ssid, const char *password) {}
+    int status() { return _status; }
+    bool isConnected() { return _status == WL_CONNECTED; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    int hostByName(const char *host, IPAddress &address);
+
+    int _status = WL_CONNECTED;
+};
+extern WiFiClass WiFi;
+
+// Test controls
+void shimRedirectPort(uint16_t port, uint16_t to); // connects to port go to to instead
+void shimSetConnectDelayMs(uint32_t ms);           // handshake time added to every connect
+uint32_t shimDnsLookups();
+uint32_t shimConnects();
+
+#endif // WIFI_H
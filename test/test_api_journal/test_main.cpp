@@ -0,0 +1,146 @@
+// ApiJournal on the in-memory SPIFFS: a failed append must not rewrite the
+// file on the tap path or lose the mutations that arrive before poll() has
+// repaired it, and a failing rewrite must back off and never lose the file.
+#include <Arduino.h>
+#include <unity.h>
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include "ApiJournal.h"
+
+static ApiJournal *journal;
+
+static bool statIs(const char *stat)
+{
+    return journal->statsJson().indexOf(stat) >= 0;
+}
+
+static uint16_t pendingAfterReboot()
+{
+    ApiJournal *rebooted = new ApiJournal();
+    rebooted->begin();
+    uint16_t pending = rebooted->pending();
+    delete rebooted;
+    return pending;
+}
+
+// One good record, then a failed append that tears the file
+static void tear()
+{
+    TEST_ASSERT_TRUE(journal->enqueue(JournalKind::CreateCreature, "{\"name\":\"Ember\"}"));
+    shimFailFsWrites(true);
+    TEST_ASSERT_TRUE(journal->enqueue(JournalKind::AddCoins, "{\"name\":\"Ember\"}"));
+    shimFailFsWrites(false);
+}
+
+void setUp()
+{
+    shimUseRealClock(false);
+    shimFormatFs();
+    shimFailFsWrites(false);
+    shimFailFsRenames(false);
+    WiFi._status = WL_DISCONNECTED; // poll() does upkeep only, nothing is sent
+    journal = new ApiJournal();
+    journal->begin();
+}
+
+void tearDown()
+{
+    delete journal;
+    shimFailFsWrites(false);
+    shimFailFsRenames(false);
+    WiFi._status = WL_CONNECTED;
+}
+
+static void test_torn_window_holds_mutations()
+{
+    tear();
+    TEST_ASSERT_TRUE(journal->enqueue(JournalKind::AddCoins, "{\"name\":\"Frost\"}"));
+    TEST_ASSERT_TRUE(statIs("\"compactions\":0")); // nothing rewritten on the tap
+    TEST_ASSERT_TRUE(statIs("\"held\":2"));
+    TEST_ASSERT_TRUE(statIs("\"dropped\":0"));
+
+    journal->poll(false); // a card is on a pad: the rewrite waits
+    TEST_ASSERT_TRUE(statIs("\"compactions\":0"));
+
+    journal->poll(true);
+    TEST_ASSERT_TRUE(statIs("\"compactions\":1"));
+    TEST_ASSERT_TRUE(statIs("\"held\":0"));
+    TEST_ASSERT_EQUAL_UINT16(3, journal->pending());
+    TEST_ASSERT_EQUAL_UINT16(3, pendingAfterReboot());
+}
+
+static void test_hold_is_bounded()
+{
+    tear();
+    for (uint8_t i = 1; i < JOURNAL_HOLD; i++)
+    {
+        TEST_ASSERT_TRUE(journal->enqueue(JournalKind::AddCoins, "{\"name\":\"Frost\"}"));
+    }
+    TEST_ASSERT_FALSE(journal->enqueue(JournalKind::AddCoins, "{\"name\":\"Frost\"}"));
+    TEST_ASSERT_TRUE(statIs("\"dropped\":1"));
+}
+
+static void test_failed_compaction_backs_off()
+{
+    tear();
+    shimFailFsWrites(true); // the flash is full
+    journal->poll(true);
+    journal->poll(true);
+    TEST_ASSERT_TRUE(statIs("\"compactions\":1"));
+    TEST_ASSERT_TRUE(statIs("\"compactFailures\":1"));
+
+    shimAdvanceMicros(JOURNAL_COMPACT_RETRY_MS * 1000ULL);
+    journal->poll(true);
+    TEST_ASSERT_TRUE(statIs("\"compactFailures\":2"));
+
+    // Space came back; the retry after the second failure is twice as far out
+    shimFailFsWrites(false);
+    shimAdvanceMicros(JOURNAL_COMPACT_RETRY_MS * 1000ULL);
+    journal->poll(true);
+    TEST_ASSERT_TRUE(statIs("\"compactions\":2"));
+    shimAdvanceMicros(JOURNAL_COMPACT_RETRY_MS * 1000ULL);
+    journal->poll(true);
+    TEST_ASSERT_TRUE(statIs("\"compactions\":3"));
+    TEST_ASSERT_TRUE(statIs("\"held\":0"));
+    TEST_ASSERT_EQUAL_UINT16(2, pendingAfterReboot());
+}
+
+static void test_failed_rename_keeps_the_journal()
+{
+    tear();
+    shimFailFsRenames(true);
+    journal->poll(true);
+    TEST_ASSERT_TRUE(statIs("\"compactFailures\":1"));
+    TEST_ASSERT_FALSE(SPIFFS.exists(JOURNAL_PATH));
+    TEST_ASSERT_TRUE(SPIFFS.exists(JOURNAL_TMP_PATH));
+    TEST_ASSERT_EQUAL_UINT16(2, journal->pending());
+
+    // A reboot now finds the rewritten file under the tmp name
+    shimFailFsRenames(false);
+    TEST_ASSERT_EQUAL_UINT16(1, pendingAfterReboot()); // the held one was not on flash yet
+}
+
+static void test_rename_is_retried()
+{
+    tear();
+    shimFailFsRenames(true);
+    journal->poll(true);
+    shimFailFsRenames(false);
+    shimAdvanceMicros(JOURNAL_COMPACT_RETRY_MS * 1000ULL);
+    journal->poll(true);
+    TEST_ASSERT_TRUE(SPIFFS.exists(JOURNAL_PATH));
+    TEST_ASSERT_FALSE(SPIFFS.exists(JOURNAL_TMP_PATH));
+    TEST_ASSERT_TRUE(statIs("\"held\":0"));
+    TEST_ASSERT_EQUAL_UINT16(2, pendingAfterReboot());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_torn_window_holds_mutations);
+    RUN_TEST(test_hold_is_bounded);
+    RUN_TEST(test_failed_compaction_backs_off);
+    RUN_TEST(test_failed_rename_keeps_the_journal);
+    RUN_TEST(test_rename_is_retried);
+    return UNITY_END();
+}
@@ -0,0 +1,101 @@
+// Group tap against the MFRC522 fake: several cards in the field at once,
+// some of which fail their auth or read. Every card must be read once and
+// halted, so a failing card cannot keep answering REQA and fill the batch.
+#include <Arduino.h>
+#include <unity.h>
+#include "CardScanner.h"
+#include "RFIDData.h"
+
+static MFRC522 reader;
+static MFRC522::MIFARE_Key key;
+
+// Places cards in the field, selects the first as the tap did, then scans
+static uint8_t scanField(FakeCard **field, uint8_t fieldCount, TapBuffer *cards)
+{
+    for (uint8_t i = 0; i < fieldCount; i++)
+    {
+        reader.fakeInsert(*field[i]);
+    }
+    TEST_ASSERT_TRUE(reader.PICC_IsNewCardPresent());
+    TEST_ASSERT_TRUE(reader.PICC_ReadCardSerial());
+
+    RFIDSession session(reader, key);
+    return scanAllCards(reader, session, cards, MAX_BATCH_CARDS);
+}
+
+void setUp()
+{
+    shimUseRealClock(false);
+    reader.fakeClearField();
+    reader.fakeCounters = {};
+    for (byte i = 0; i < 6; i++)
+    {
+        key.keyByte[i] = 0xFF;
+    }
+}
+
+void tearDown()
+{
+    reader.fakeClearField(); // the cards were locals of the test
+}
+
+static void test_failing_cards_are_scanned_once()
+{
+    FakeCard a(0x33000001), b(0x33000002), c(0x33000003), d(0x33000004);
+    b.failAuths = 1;
+    c.failReads = 1;
+    FakeCard *field[] = {&a, &b, &c, &d};
+    TapBuffer cards[MAX_BATCH_CARDS];
+
+    uint8_t count = scanField(field, 4, cards);
+
+    TEST_ASSERT_EQUAL_UINT8(4, count);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL_MEMORY(field[i]->uid.uidByte, cards[i].uid.uidByte, 4);
+        TEST_ASSERT_TRUE(field[i]->state == FakeCard::Halt);
+    }
+    TEST_ASSERT_TRUE(cards[0].loaded);
+    TEST_ASSERT_FALSE(cards[1].loaded);
+    TEST_ASSERT_FALSE(cards[2].loaded);
+    TEST_ASSERT_TRUE(cards[3].loaded);
+}
+
+static void test_scan_rate_by_field_size()
+{
+    const uint8_t sizes[] = {1, 2, 4, MAX_BATCH_CARDS};
+    for (uint8_t s = 0; s < sizeof(sizes); s++)
+    {
+        reader.fakeClearField();
+        FakeCard *field[MAX_BATCH_CARDS];
+        for (uint8_t i = 0; i < sizes[s]; i++)
+        {
+            field[i] = new FakeCard(0x34000000 + s * 16 + i);
+            field[i]->failReads = (i % 3 == 2) ? 1 : 0; // every third card fails once
+        }
+        TapBuffer cards[MAX_BATCH_CARDS];
+
+        uint8_t count = scanField(field, sizes[s], cards);
+
+        TEST_ASSERT_EQUAL_UINT8(sizes[s], count);
+        const CardScanStats &stats = cardScanStats();
+        char line[96];
+        snprintf(line, sizeof(line), "%u cards: %u ms, %.1f cards/s", (unsigned)count, (unsigned)stats.lastMs,
+                 stats.lastCardsPerSec);
+        TEST_MESSAGE(line);
+
+        reader.fakeClearField();
+        for (uint8_t i = 0; i < sizes[s]; i++)
+        {
+            delete field[i];
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_failing_cards_are_scanned_once);
+    RUN_TEST(test_scan_rate_by_field_size);
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+// CardDetect with a fake IRQ line: the MFRC522 fake raises the IRQ pin when
+// a card answers the armed REQA, as the chip does. Measures IRQ edge ->
+// card selected (the handler side) and card arrival -> detection, against
+// the polling fallback, on the simulated clock.
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include "CardDetect.h"
+#include "GlobalDefs.h"
+
+#define TEST_IRQ_PIN 4
+#define LOOP_US 1000 // rest of loop() between two cardDetectPoll() calls
+#define TRIALS 20
+
+static MFRC522 reader;
+
+struct DetectRun
+{
+    uint32_t avgArrivalUs; // card placed -> cardDetectPoll() returned true
+    uint32_t maxArrivalUs;
+    uint32_t blockedUsPerSec; // time cardDetectPoll() held loop() while no card was there
+};
+
+// Places a card at staggered moments and runs loop() until it is detected
+static DetectRun runTrials()
+{
+    DetectRun run = {0, 0, 0};
+    uint64_t totalArrivalUs = 0;
+    uint64_t idleUs = 0;
+    uint64_t blockedIdleUs = 0;
+    for (uint8_t trial = 0; trial < TRIALS; trial++)
+    {
+        FakeCard card(0xC0DE0000 + trial);
+        unsigned long start = micros();
+        unsigned long arriveAfterUs = 7000 + trial * 37000UL; // spread across the poll and re-arm periods
+        unsigned long arrivedAt = 0;
+        bool inField = false;
+        while (true)
+        {
+            if (!inField && micros() - start >= arriveAfterUs)
+            {
+                reader.fakeInsert(card);
+                arrivedAt = micros();
+                inField = true;
+            }
+            unsigned long before = micros();
+            bool detected = cardDetectPoll(reader);
+            if (!inField)
+            {
+                blockedIdleUs += micros() - before;
+            }
+            if (detected)
+            {
+                break;
+            }
+            shimAdvanceMicros(LOOP_US);
+            TEST_ASSERT_TRUE_MESSAGE(micros() - start < 5000000UL, "card never detected");
+        }
+        uint32_t arrivalUs = micros() - arrivedAt;
+        TEST_ASSERT_EQUAL_MEMORY(card.uid.uidByte, reader.uid.uidByte, 4);
+        totalArrivalUs += arrivalUs;
+        run.maxArrivalUs = max(run.maxArrivalUs, arrivalUs);
+        idleUs += arrivedAt - start;
+
+        reader.PICC_HaltA();
+        reader.fakeRemove(card);
+    }
+    run.avgArrivalUs = totalArrivalUs / TRIALS;
+    run.blockedUsPerSec = blockedIdleUs * 1000000ULL / idleUs;
+    return run;
+}
+
+void setUp()
+{
+    shimUseRealClock(false);
+    reader.fakeClearField();
+    reader.fakeIrqPin = TEST_IRQ_PIN;
+}
+
+void tearDown()
+{
+    cardDetectDisarm(reader);
+}
+
+static void test_irq_wakes_the_handler_within_one_loop()
+{
+    cardDetectBegin(reader, TEST_IRQ_PIN);
+    TEST_ASSERT_TRUE(cardDetectUsesIrq());
+
+    DetectRun irq = runTrials();
+
+    // The ISR only notifies; the select runs on the next poll. Edge to
+    // selected card is one loop() pass plus the select frame.
+    TEST_ASSERT_GREATER_THAN(0, lastDetectLatencyUs());
+    TEST_ASSERT_LESS_OR_EQUAL(LOOP_US + FAKE_SELECT_US, lastDetectLatencyUs());
+    // A card is noticed by the next re-armed REQA
+    TEST_ASSERT_LESS_OR_EQUAL(CARD_IRQ_REARM_MS * 1000UL + 2 * LOOP_US + FAKE_SELECT_US, irq.maxArrivalUs);
+    // Arming never waits out a reader timeout
+    TEST_ASSERT_EQUAL_UINT32(0, irq.blockedUsPerSec);
+
+    String stats = cardDetectStatsJson();
+    TEST_ASSERT_TRUE(stats.indexOf("\"irq\":true") >= 0);
+    TEST_ASSERT_TRUE(stats.indexOf("\"irqDetections\":" + String(TRIALS)) >= 0);
+
+    char line[160];
+    snprintf(line, sizeof(line), "IRQ: edge->select %u us, arrival->detect avg %u us max %u us, idle blocking %u us/s",
+             (unsigned)lastDetectLatencyUs(), (unsigned)irq.avgArrivalUs, (unsigned)irq.maxArrivalUs,
+             (unsigned)irq.blockedUsPerSec);
+    TEST_MESSAGE(line);
+}
+
+static void test_irq_beats_polling()
+{
+    cardDetectBegin(reader, TEST_IRQ_PIN);
+    DetectRun irq = runTrials();
+    cardDetectBegin(reader, -1);
+    TEST_ASSERT_FALSE(cardDetectUsesIrq());
+    DetectRun polled = runTrials();
+
+    TEST_ASSERT_LESS_THAN(polled.avgArrivalUs, irq.avgArrivalUs);
+    TEST_ASSERT_LESS_THAN(polled.maxArrivalUs, irq.maxArrivalUs);
+    // Each idle poll waits out a REQA timeout on the bus
+    TEST_ASSERT_GREATER_THAN(irq.blockedUsPerSec, polled.blockedUsPerSec);
+
+    char line[160];
+    snprintf(line, sizeof(line), "Polling: arrival->detect avg %u us max %u us, idle blocking %u us/s",
+             (unsigned)polled.avgArrivalUs, (unsigned)polled.maxArrivalUs, (unsigned)polled.blockedUsPerSec);
+    TEST_MESSAGE(line);
+}
+
+// Wall-clock milliseconds cardDetectWait() blocked for; the notification wait runs on real time
+static uint32_t timedWait(uint32_t maxMs)
+{
+    auto start = std::chrono::steady_clock::now();
+    cardDetectWait(maxMs);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void test_idle_loop_sleeps_until_the_irq()
+{
+    cardDetectBegin(reader, TEST_IRQ_PIN);
+    TEST_ASSERT_FALSE(cardDetectPoll(reader)); // arms the IRQ
+
+    // No card: the loop task sleeps the whole re-arm period instead of spinning
+    TEST_ASSERT_GREATER_OR_EQUAL(CARD_IRQ_REARM_MS - 5, timedWait(CARD_IRQ_REARM_MS));
+    TEST_ASSERT_FALSE(cardDetectPoll(reader));
+
+    // A card answers the next REQA: the wait returns at once and the poll selects it
+    FakeCard card(0xC0DE1000);
+    reader.fakeInsert(card);
+    shimAdvanceMicros(CARD_IRQ_REARM_MS * 1000UL);
+    TEST_ASSERT_FALSE(cardDetectPoll(reader)); // re-arms; the card raises the IRQ
+    TEST_ASSERT_LESS_THAN(5, timedWait(CARD_IRQ_REARM_MS));
+    TEST_ASSERT_TRUE(cardDetectPoll(reader));
+    TEST_ASSERT_EQUAL_MEMORY(card.uid.uidByte, reader.uid.uidByte, 4);
+    reader.PICC_HaltA();
+    reader.fakeRemove(card);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_irq_wakes_the_handler_within_one_loop);
+    RUN_TEST(test_irq_beats_polling);
+    RUN_TEST(test_idle_loop_sleeps_until_the_irq);
+    return UNITY_END();
+}
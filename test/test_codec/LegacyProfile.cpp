@@ -0,0 +1,143 @@
+#include "LegacyProfile.h"
+#include "CoinStore.h" // BOOLS_MASK
+#include <stdio.h>
+
+namespace legacy
+{
+
+static bool allChallBools = false;
+
+String parseProfileBlock(const byte *buffer, int &intPart, String &strPart)
+{
+    // Convert buffer to String (16 bytes + possible null terminators)
+    String result;
+    for (byte i = 0; i < 16; i++)
+    {
+        result += (char)buffer[i];
+    }
+
+    // Remove only trailing null characters
+    while (result.length() > 0 && result[result.length() - 1] == '\0')
+    {
+        result.remove(result.length() - 1, 1);
+    }
+
+    Serial.print("[parseProfileBlock] Raw block content: ");
+    Serial.println(result);
+
+    // Separate the raw data into intPart (left of '%') and strPart (right of '%')
+    int sepIndex = result.indexOf('%');
+    if (sepIndex != -1)
+    {
+        String intPartStr = result.substring(0, sepIndex);
+        strPart = result.substring(sepIndex + 1);
+        intPart = intPartStr.toInt();
+
+        // Check if all booleans are true (assuming they are stored in the lower bits of intPart)
+        bool A = (intPart & 0x01) != 0;
+        bool B = (intPart & 0x02) != 0;
+        bool C = (intPart & 0x04) != 0;
+        bool D = (intPart & 0x08) != 0;
+
+        Serial.println("[parseProfileBlock] Bool values:");
+        Serial.println("A: " + String(A));
+        Serial.println("B: " + String(B));
+        Serial.println("C: " + String(C));
+        Serial.println("D: " + String(D));
+
+        if (A && B && C && D)
+        {
+            allChallBools = true;
+            Serial.println("[parseProfileBlock] allChallBools set to TRUE");
+        }
+        else
+        {
+            allChallBools = false;
+            Serial.println("[parseProfileBlock] allChallBools set to FALSE");
+        }
+    }
+    else
+    {
+        return "blank profile";
+    }
+
+    return result;
+}
+
+void encodeProfileBlock(const RFIDData &data, byte *dataBlock)
+{
+    // Create payload: "AA CC TT BB %NAME"
+    char buffer[15];
+    memset(buffer, 0, sizeof(buffer));
+    snprintf(buffer, sizeof(buffer), "%02d%02d%02d%02d%%%s",
+             data.age,
+             data.coins,
+             data.creatureType,
+             data.bools,
+             data.name.substring(0, 6).c_str());
+    String payload = String(buffer);
+
+    // Debug
+    Serial.print("[encodeProfileBlock] Final payload: ");
+    Serial.println(payload);
+
+    // Zero-padded 16-byte block
+    memset(dataBlock, 0, 16);
+    for (int i = 0; i < 16 && i < (int)payload.length(); i++)
+    {
+        dataBlock[i] = payload.charAt(i);
+    }
+}
+
+Creature decode(int numericPart, const String &namePart)
+{
+    // The Creature struct, per your new system, should look similar to:
+    // struct Creature {
+    //     int trainerAge;
+    //     int coins;
+    //     int creatureType;
+    //     String customName;
+    //     int intVal; // was boolVal
+    // };
+
+    Creature c;
+
+    // Convert numericPart to an 8-digit string (leading zeros included)
+    char buffer[9];
+    snprintf(buffer, sizeof(buffer), "%08d", numericPart);
+    String mainData = buffer;
+
+    // We expect exactly 8 chars: [0..1]=age, [2..3]=coins, [4..5]=creatureType, [6..7]=intVal
+    if (mainData.length() < 8)
+    {
+        Serial.println("[decode] Not enough digits in numericPart");
+        return c; // return empty if invalid
+    }
+
+    // Parse fields
+    c.trainerAge = mainData.substring(0, 2).toInt();
+    c.coins = mainData.substring(2, 4).toInt();
+    c.creatureType = mainData.substring(4, 6).toInt();
+    c.intVal = mainData.substring(6, 8).toInt() & BOOLS_MASK; // drop storage flags
+
+    // Use namePart directly for customName (up to 6 chars if you want to limit it)
+    // For now, let's just store the full string:
+    c.customName = namePart;
+
+    // Debug output
+    Serial.println("[decode] Created Creature from numericPart & namePart:");
+    Serial.print("  Age: ");
+    Serial.println(c.trainerAge);
+    Serial.print("  Coins: ");
+    Serial.println(c.coins);
+    Serial.print("  CreatureType: ");
+    Serial.println(c.creatureType);
+    Serial.print("  customName: ");
+    Serial.println(c.customName);
+    Serial.print("  intVal: ");
+    Serial.println(c.intVal);
+
+    return c;
+}
+
+} // namespace legacy
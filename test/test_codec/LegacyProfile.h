@@ -0,0 +1,38 @@
+// LegacyProfile.h
+// Host copy of the String-based profile parse and encode that ProfileCodec
+// replaced, kept so test_codec can time the two side by side. Copied as
+// it ran on the tap path, Serial output included; only the names moved
+// into a namespace so they do not clash with the current ones.
+#ifndef LEGACYPROFILE_H
+#define LEGACYPROFILE_H
+
+#include <Arduino.h>
+
+namespace legacy
+{
+
+struct RFIDData
+{
+    String name;      // 6 characters max
+    int age;          // 00-99
+    int coins;        // 00-99
+    int creatureType; // 00-34 (0 reserved for 'no creature')
+    uint8_t bools;    // 0-15 representing 4 boolean values
+};
+
+struct Creature
+{
+    int trainerAge;
+    int coins;
+    int creatureType;
+    String customName;
+    int intVal;
+};
+
+String parseProfileBlock(const byte *buffer, int &intPart, String &strPart);
+Creature decode(int numericPart, const String &namePart);
+void encodeProfileBlock(const RFIDData &data, byte *dataBlock);
+
+} // namespace legacy
+
+#endif // LEGACYPROFILE_H
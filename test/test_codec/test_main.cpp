@@ -0,0 +1,241 @@
+// ProfileCodec on the host: known records, a seeded random corpus and a
+// micro-benchmark against the String parse it replaced (LegacyProfile).
+// Heap allocations are counted through operator new, so a codec change that
+// starts allocating per call fails here before it reaches the device.
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+#include "ProfileCodec.h"
+#include "CodecBench.h"
+#include "LegacyProfile.h"
+
+#define BENCH_CALLS 200000
+#define CORPUS_BLOCKS 200000
+
+static uint64_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+static volatile uint8_t sink; // keeps timed calls from being optimised away
+
+static ProfileFields sample()
+{
+    ProfileFields fields = {};
+    fields.age = 12;
+    fields.coins = 40;
+    fields.creatureType = 26;
+    fields.bools = 0x1F;
+    strcpy(fields.name, "Flamey");
+    return fields;
+}
+
+struct CallCost
+{
+    double ns;
+    double allocations;
+};
+
+template <typename Call>
+static CallCost measure(Call call)
+{
+    uint64_t allocationsBefore = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++)
+    {
+        call();
+    }
+    auto spent = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return {(double)spent.count() / BENCH_CALLS, (double)(allocations - allocationsBefore) / BENCH_CALLS};
+}
+
+static void report(const char *name, const CallCost &cost, const CallCost &before)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%s: %.1f ns, %.2f allocations per call (String path %.1f ns, %.2f allocations, %.1fx)",
+             name, cost.ns, cost.allocations, before.ns, before.allocations, before.ns / cost.ns);
+    TEST_MESSAGE(line);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_binary_round_trip()
+{
+    ProfileFields in = sample();
+    uint8_t block[PROFILE_BLOCK_SIZE];
+    TEST_ASSERT_TRUE(encodeProfile(in, block) == ProfileError::Ok);
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_FORMAT_V1, block[0]);
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_VERSION_V1, profileVersion(block));
+
+    ProfileFields out;
+    TEST_ASSERT_TRUE(decodeProfile(block, out) == ProfileError::Ok);
+    TEST_ASSERT_EQUAL_UINT8(in.age, out.age);
+    TEST_ASSERT_EQUAL_UINT16(in.coins, out.coins);
+    TEST_ASSERT_EQUAL_UINT8(in.creatureType, out.creatureType);
+    TEST_ASSERT_EQUAL_UINT8(in.bools, out.bools);
+    TEST_ASSERT_EQUAL_STRING(in.name, out.name);
+}
+
+static void test_legacy_ascii_and_blank()
+{
+    const uint8_t ascii[PROFILE_BLOCK_SIZE] = {'1', '2', '4', '0', '2', '6', '1', '5', '%', 'F', 'l', 'a', 'm', 'e', 'y', 0};
+    ProfileFields out;
+    TEST_ASSERT_TRUE(decodeProfile(ascii, out) == ProfileError::Ok);
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_VERSION_ASCII, profileVersion(ascii));
+    TEST_ASSERT_EQUAL_UINT16(40, out.coins);
+    TEST_ASSERT_EQUAL_STRING("Flamey", out.name);
+
+    uint8_t blank[PROFILE_BLOCK_SIZE] = {0};
+    TEST_ASSERT_TRUE(decodeProfile(blank, out) == ProfileError::Blank);
+    TEST_ASSERT_FALSE(profileRejected(ProfileError::Blank));
+}
+
+static void test_rejects_bad_input()
+{
+    uint8_t block[PROFILE_BLOCK_SIZE];
+    ProfileFields in = sample();
+    encodeProfile(in, block);
+
+    // Every single-bit error in a binary record must be caught, never read as blank
+    for (uint8_t bit = 0; bit < PROFILE_BLOCK_SIZE * 8; bit++)
+    {
+        uint8_t flipped[PROFILE_BLOCK_SIZE];
+        memcpy(flipped, block, sizeof(flipped));
+        flipped[bit / 8] ^= 1 << (bit % 8);
+        ProfileFields out;
+        ProfileError error = decodeProfile(flipped, out);
+        TEST_ASSERT_TRUE_MESSAGE(error != ProfileError::Ok && error != ProfileError::Blank, "bit flip accepted");
+    }
+
+    uint8_t untouched[PROFILE_BLOCK_SIZE];
+    memcpy(untouched, block, sizeof(untouched));
+    in.age = ProfileMax::age + 1;
+    TEST_ASSERT_TRUE(encodeProfile(in, block) == ProfileError::OutOfRange);
+    in = sample();
+    strcpy(in.name, "Bad!");
+    TEST_ASSERT_TRUE(encodeProfile(in, block) == ProfileError::BadName);
+    strcpy(in.name, "Bob ");
+    TEST_ASSERT_TRUE(encodeProfile(in, block) == ProfileError::BadName);
+    TEST_ASSERT_EQUAL_MEMORY(untouched, block, PROFILE_BLOCK_SIZE);
+
+    // Sanitized, the same name is stored as it reads back
+    sanitizeProfileName(in.name);
+    TEST_ASSERT_TRUE(encodeProfile(in, block) == ProfileError::Ok);
+    ProfileFields out;
+    TEST_ASSERT_TRUE(decodeProfile(block, out) == ProfileError::Ok);
+    TEST_ASSERT_EQUAL_STRING("Bob", out.name);
+}
+
+static void test_random_corpus()
+{
+    // The same pass /codecBench runs on the device, over a larger seeded corpus
+    shimSeedRandom(0xC0DEC0DE);
+    uint32_t blocks = 0;
+    uint32_t decoded = 0;
+    while (blocks < CORPUS_BLOCKS)
+    {
+        CodecBenchResult result = runCodecBench(1, CODEC_BENCH_MAX_RUNS);
+        TEST_ASSERT_EQUAL_UINT32(0, result.roundTripErrors);
+        TEST_ASSERT_EQUAL_UINT32(0, result.bitFlipsMissed);
+        blocks += result.fuzzBlocks;
+        decoded += result.fuzzDecoded;
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(0, decoded);
+
+    char line[96];
+    snprintf(line, sizeof(line), "Corpus: %u blocks, %u decoded, 0 round-trip errors", (unsigned)blocks,
+             (unsigned)decoded);
+    TEST_MESSAGE(line);
+}
+
+static void test_bench()
+{
+    ProfileFields in = sample();
+    uint8_t binary[PROFILE_BLOCK_SIZE];
+    encodeProfile(in, binary);
+    const uint8_t ascii[PROFILE_BLOCK_SIZE] = {'1', '2', '4', '0', '2', '6', '1', '5', '%', 'F', 'l', 'a', 'm', 'e', 'y', 0};
+    ProfileFields out;
+    uint8_t block[PROFILE_BLOCK_SIZE];
+
+    CallCost decodeBinary = measure([&] { sink = (uint8_t)decodeProfile(binary, out); });
+    CallCost decodeAscii = measure([&] { sink = (uint8_t)decodeProfile(ascii, out); });
+    CallCost encode = measure([&] { sink = (uint8_t)encodeProfile(in, block); });
+
+    // The tap path before the codec: block to String, split at '%', then decode()
+    CallCost legacyDecode = measure([&] {
+        int intPart = 0;
+        String strPart;
+        legacy::parseProfileBlock(ascii, intPart, strPart);
+        sink = (uint8_t)legacy::decode(intPart, strPart).coins;
+    });
+    legacy::RFIDData legacyIn = {in.name, in.age, in.coins, in.creatureType, in.bools};
+    CallCost legacyEncode = measure([&] {
+        legacy::encodeProfileBlock(legacyIn, block);
+        sink = block[0];
+    });
+
+    report("decode binary", decodeBinary, legacyDecode);
+    report("decode ascii", decodeAscii, legacyDecode);
+    report("encode", encode, legacyEncode);
+
+    // The codec runs on every tap: it must never touch the heap
+    TEST_ASSERT_TRUE(decodeBinary.allocations == 0);
+    TEST_ASSERT_TRUE(decodeAscii.allocations == 0);
+    TEST_ASSERT_TRUE(encode.allocations == 0);
+    // The tap decodes on every card; the host has no UART, so the String
+    // path's Serial output costs it far less here than on the device
+    TEST_ASSERT_TRUE(decodeBinary.ns < legacyDecode.ns);
+    TEST_ASSERT_TRUE(decodeAscii.ns < legacyDecode.ns);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_binary_round_trip);
+    RUN_TEST(test_legacy_ascii_and_blank);
+    RUN_TEST(test_rejects_bad_input);
+    RUN_TEST(test_random_corpus);
+    RUN_TEST(test_bench);
+    return UNITY_END();
+}
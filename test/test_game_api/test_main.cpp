@@ -0,0 +1,121 @@
+// GameApiClient against a stand-in HTTP/1.1 server over real loopback
+// sockets: a tap's calls share one kept-alive connection and one DNS
+// lookup, and the handshake that saves is measured with a simulated
+// connect latency.
+#include <Arduino.h>
+#include <unity.h>
+#include "GameApi.h"
+#include "StandInServer.h"
+
+#define HANDSHAKE_MS 40 // connect time on the simulated link
+#define TIMED_CALLS 8
+
+static StandInServer server;
+
+static void answer(const StandInRequest &request, StandInResponse &response)
+{
+    response.body = request.method == "GET" ? "[]" : "{\"ok\":true}";
+}
+
+static bool countElement(JsonVariantConst element, void *context)
+{
+    (*(uint32_t *)context)++;
+    return true;
+}
+
+static bool readList(Stream &body, void *context)
+{
+    return readJsonArray(body, countElement, context);
+}
+
+// The calls finishTap makes for a new creature that earned a coin
+static void tapCalls(GameApiClient &api)
+{
+    uint32_t elements = 0;
+    TEST_ASSERT_EQUAL_INT(200, api.get("/api/creatures", readList, &elements));
+    TEST_ASSERT_EQUAL_INT(200, api.postJson("/api/creatures", "{\"name\":\"Flamey\"}"));
+    TEST_ASSERT_EQUAL_INT(200, api.postJson("/api/coins", "{\"name\":\"Flamey\",\"amount\":5}", nullptr, nullptr, "tap-1"));
+}
+
+void setUp()
+{
+    shimUseRealClock(true); // real sockets, real time
+    shimSetConnectDelayMs(0);
+    TEST_ASSERT_TRUE(server.start(GAME_API_PORT, answer));
+}
+
+void tearDown()
+{
+    server.stop();
+}
+
+static void test_tap_shares_one_connection()
+{
+    GameApiClient api;
+    uint32_t lookups = shimDnsLookups();
+    tapCalls(api);
+
+    TEST_ASSERT_EQUAL_UINT32(1, server.connections());
+    TEST_ASSERT_EQUAL_UINT32(3, server.requests());
+    TEST_ASSERT_EQUAL_UINT32(1, api.connects());
+    TEST_ASSERT_EQUAL_UINT32(1, shimDnsLookups() - lookups);
+    std::vector<StandInRequest> received = server.received();
+    TEST_ASSERT_EQUAL_STRING("tap-1", received[2].idempotencyKey.c_str());
+}
+
+static void test_server_close_reopens_transparently()
+{
+    StandInServer closing;
+    server.stop();
+    TEST_ASSERT_TRUE(closing.start(GAME_API_PORT, [](const StandInRequest &request, StandInResponse &response) {
+        response.close = true; // Connection: close on every reply
+    }));
+
+    GameApiClient api;
+    TEST_ASSERT_EQUAL_INT(200, api.get("/api/creatures"));
+    TEST_ASSERT_EQUAL_INT(200, api.get("/api/creatures"));
+    TEST_ASSERT_EQUAL_UINT32(2, closing.connections());
+    TEST_ASSERT_EQUAL_UINT32(2, api.connects());
+    closing.stop();
+}
+
+static void test_keep_alive_saves_the_handshake()
+{
+    shimSetConnectDelayMs(HANDSHAKE_MS);
+
+    GameApiClient warm;
+    unsigned long start = millis();
+    for (uint8_t i = 0; i < TIMED_CALLS; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(200, warm.get("/api/creatures"));
+    }
+    unsigned long warmMs = millis() - start;
+
+    GameApiClient cold;
+    start = millis();
+    for (uint8_t i = 0; i < TIMED_CALLS; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(200, cold.get("/api/creatures"));
+        cold.closeAll(); // what every call paid before connections were kept
+    }
+    unsigned long coldMs = millis() - start;
+
+    TEST_ASSERT_EQUAL_UINT32(1, warm.connects());
+    TEST_ASSERT_EQUAL_UINT32(TIMED_CALLS, cold.connects());
+    // Every call after the first skips one handshake; half of it allows for a busy host
+    TEST_ASSERT_TRUE(coldMs >= warmMs + (TIMED_CALLS - 1) * HANDSHAKE_MS / 2);
+
+    char line[128];
+    snprintf(line, sizeof(line), "%u calls, %u ms handshake: kept alive %lu ms, reconnecting %lu ms",
+             (unsigned)TIMED_CALLS, (unsigned)HANDSHAKE_MS, warmMs, coldMs);
+    TEST_MESSAGE(line);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tap_shares_one_connection);
+    RUN_TEST(test_server_close_reopens_transparently);
+    RUN_TEST(test_keep_alive_saves_the_handshake);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// NameIndex on the host: lookups and additions, the flash copy on the
+// in-memory SPIFFS, and a refresh streamed from a stand-in game server.
+#include <Arduino.h>
+#include <unity.h>
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include "NameIndex.h"
+#include "GameApi.h"
+#include "StandInServer.h"
+
+// Each one holds NAME_INDEX_CAPACITY hashes, too many for the stack
+static NameIndex *names;
+static NameIndex *rebooted;
+
+static StandInServer server;
+static std::string serverNames;
+static int serverStatus;
+
+static void answer(const StandInRequest &request, StandInResponse &response)
+{
+    response.status = serverStatus;
+    response.body = request.path == NAME_INDEX_API_PATH ? serverNames : "{}";
+}
+
+void setUp()
+{
+    shimFormatFs();
+    WiFi._status = WL_DISCONNECTED; // poll() only writes flash, no refresh
+    names = new NameIndex();
+    rebooted = new NameIndex();
+}
+
+void tearDown()
+{
+    delete names;
+    delete rebooted;
+    WiFi._status = WL_CONNECTED;
+}
+
+static void test_contains_after_add()
+{
+    TEST_ASSERT_FALSE(names->ready());
+    TEST_ASSERT_FALSE(names->contains("Flamey"));
+
+    names->add("Flamey");
+    names->add("Frost");
+    names->add("Flamey");
+    TEST_ASSERT_EQUAL_UINT16(2, names->size());
+    TEST_ASSERT_TRUE(names->contains("Flamey"));
+    TEST_ASSERT_TRUE(names->contains("Frost"));
+    TEST_ASSERT_FALSE(names->contains("flamey")); // names are case sensitive
+    TEST_ASSERT_TRUE(names->statsJson().indexOf("\"hits\":2") >= 0);
+}
+
+static void test_flash_round_trip()
+{
+    names->add("Flamey");
+    names->add("Frost");
+    names->poll(false); // a card is on a pad: no flash write yet
+    TEST_ASSERT_FALSE(SPIFFS.exists(NAME_INDEX_PATH));
+    names->poll(true);
+    TEST_ASSERT_TRUE(SPIFFS.exists(NAME_INDEX_PATH));
+
+    rebooted->begin();
+    TEST_ASSERT_TRUE(rebooted->ready());
+    TEST_ASSERT_EQUAL_UINT16(2, rebooted->size());
+    TEST_ASSERT_TRUE(rebooted->contains("Flamey"));
+    TEST_ASSERT_TRUE(rebooted->contains("Frost"));
+}
+
+static void test_torn_file_is_ignored()
+{
+    names->add("Flamey");
+    names->poll(true);
+
+    // Cut the file short of the hashes its header promises
+    File file = SPIFFS.open(NAME_INDEX_PATH, FILE_READ);
+    uint8_t saved[8];
+    TEST_ASSERT_EQUAL(sizeof(saved), file.read(saved, sizeof(saved)));
+    file.close();
+    file = SPIFFS.open(NAME_INDEX_PATH, FILE_WRITE);
+    file.write(saved, sizeof(saved));
+    file.close();
+
+    rebooted->begin();
+    TEST_ASSERT_FALSE(rebooted->ready());
+    TEST_ASSERT_EQUAL_UINT16(0, rebooted->size());
+}
+
+static void test_refresh_from_server()
+{
+    TEST_ASSERT_TRUE(server.start(GAME_API_PORT, answer));
+    WiFi._status = WL_CONNECTED;
+    serverStatus = 200;
+    serverNames = "[\"Ember\",\"Frost\",null,\"Ember\"]"; // a non-name and a duplicate
+
+    names->add("Newborn"); // queued on this unit, not on the server yet
+
+    NetResult result;
+    memset(&result, 0, sizeof(result));
+    result.kind = NetRequestKind::RefreshNames;
+    result.status = NameIndex::fetch(result);
+    TEST_ASSERT_EQUAL_INT(200, result.status);
+    TEST_ASSERT_NOT_NULL(result.names);
+    TEST_ASSERT_EQUAL_UINT16(2, result.nameCount);
+
+    names->apply(result);
+    TEST_ASSERT_NULL(result.names);
+    TEST_ASSERT_TRUE(names->ready());
+    TEST_ASSERT_EQUAL_UINT16(3, names->size());
+    TEST_ASSERT_TRUE(names->contains("Ember"));
+    TEST_ASSERT_TRUE(names->contains("Frost"));
+    TEST_ASSERT_TRUE(names->contains("Newborn")); // put back after the refresh
+
+    // A failed refresh leaves the index as it was
+    serverStatus = 500;
+    memset(&result, 0, sizeof(result));
+    result.kind = NetRequestKind::RefreshNames;
+    result.status = NameIndex::fetch(result);
+    TEST_ASSERT_EQUAL_INT(500, result.status);
+    TEST_ASSERT_NULL(result.names);
+    names->apply(result);
+    TEST_ASSERT_EQUAL_UINT16(3, names->size());
+    TEST_ASSERT_TRUE(names->statsJson().indexOf("\"syncFailures\":1") >= 0);
+
+    gameApi.closeAll();
+    server.stop();
+}
+
+int main(int argc, char **argv)
+{
+    shimUseRealClock(true); // the refresh runs over real sockets
+    UNITY_BEGIN();
+    RUN_TEST(test_contains_after_add);
+    RUN_TEST(test_flash_round_trip);
+    RUN_TEST(test_torn_file_is_ignored);
+    RUN_TEST(test_refresh_from_server);
+    return UNITY_END();
+}
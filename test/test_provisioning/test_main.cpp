@@ -0,0 +1,92 @@
+// ProvisionQueue: a job claimed by a reader must not land on whatever the
+// queue holds after a clear() from the web task.
+#include <Arduino.h>
+#include <unity.h>
+#include "Provisioning.h"
+
+static ProvisionQueue queue;
+
+static ProfileFields profile(const char *name)
+{
+    ProfileFields fields = {};
+    fields.age = 10;
+    strcpy(fields.name, name);
+    return fields;
+}
+
+void setUp()
+{
+    queue.clear();
+}
+
+void tearDown()
+{
+}
+
+static void test_claim_survives_until_written()
+{
+    TEST_ASSERT_TRUE(queue.add(profile("Ember")));
+    ProfileFields data;
+    uint16_t generation;
+    int index = queue.claim(data, generation);
+    TEST_ASSERT_EQUAL_INT(0, index);
+    TEST_ASSERT_EQUAL_STRING("Ember", data.name);
+    TEST_ASSERT_TRUE(queue.isClaimed(index, generation));
+
+    MFRC522::Uid uid = {4, {1, 2, 3, 4}, 0x08};
+    queue.markWritten(index, generation, uid);
+    TEST_ASSERT_EQUAL_UINT8(1, queue.written());
+    TEST_ASSERT_FALSE(queue.isClaimed(index, generation));
+    TEST_ASSERT_FALSE(queue.hasQueued());
+}
+
+static void test_clear_voids_claims_in_flight()
+{
+    TEST_ASSERT_TRUE(queue.add(profile("Ember")));
+    ProfileFields data;
+    uint16_t oldGeneration;
+    int oldIndex = queue.claim(data, oldGeneration);
+
+    // The web task clears and queues a new batch while the reader waits for a card
+    queue.clear();
+    TEST_ASSERT_TRUE(queue.add(profile("Frost")));
+    uint16_t generation;
+    int index = queue.claim(data, generation);
+    TEST_ASSERT_EQUAL_INT(oldIndex, index); // same slot, new job
+    TEST_ASSERT_FALSE(queue.isClaimed(oldIndex, oldGeneration));
+
+    MFRC522::Uid uid = {4, {1, 2, 3, 4}, 0x08};
+    queue.markWritten(oldIndex, oldGeneration, uid);
+    queue.markFailed(oldIndex, oldGeneration);
+    queue.release(oldIndex, oldGeneration);
+    TEST_ASSERT_EQUAL_UINT8(0, queue.written());
+    TEST_ASSERT_EQUAL_UINT8(0, queue.failed());
+    TEST_ASSERT_TRUE(queue.isClaimed(index, generation));
+    TEST_ASSERT_TRUE(queue.statusJson().indexOf("\"attempts\":0") >= 0);
+}
+
+static void test_rate_between_first_and_last_card()
+{
+    shimUseRealClock(false);
+    MFRC522::Uid uid = {4, {1, 2, 3, 4}, 0x08};
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_TRUE(queue.add(profile("Card")));
+        ProfileFields data;
+        uint16_t generation;
+        int index = queue.claim(data, generation);
+        shimAdvanceMicros(10000000ULL); // a card every 10 s
+        queue.markWritten(index, generation, uid);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, queue.cardsPerMinute());
+}
+
+int main(int argc, char **argv)
+{
+    queue.begin();
+    UNITY_BEGIN();
+    RUN_TEST(test_claim_survives_until_written);
+    RUN_TEST(test_clear_voids_claims_in_flight);
+    RUN_TEST(test_rate_between_first_and_last_card);
+    return UNITY_END();
+}
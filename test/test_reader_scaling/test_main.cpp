@@ -0,0 +1,134 @@
+// Several reader pads on one bus, each with its own RFIDTransaction, served
+// round-robin one poll() per turn as loop() does. Players put a card down,
+// the pad reads it, and the next card arrives HANDLING_MS after the lift.
+// The fake's frames all run on one clock, as they share one SPI bus, so the
+// gain from more pads is the card handling time they overlap.
+#include <Arduino.h>
+#include <unity.h>
+#include "RFIDTransaction.h"
+#include "CardDetect.h"
+#include "TapBuffer.h"
+
+#define MAX_PADS 4
+#define HANDLING_MS 400 // lift one card, put the next one down
+#define LOOP_US 1000    // delay(1) once per round of pads
+#define SIM_MS 20000
+
+static MFRC522::MIFARE_Key key;
+
+struct Pad
+{
+    Pad() : tx(mfrc522, key), card(nullptr), nextCardAt(0), taps(0) {}
+
+    MFRC522 mfrc522;
+    RFIDTransaction tx;
+    FakeCard *card;
+    unsigned long nextCardAt;
+    uint32_t taps;
+};
+
+// Built once: card detection keeps its poll timer per reader
+static Pad pads[MAX_PADS];
+
+// Taps per second across `count` pads over SIM_MS of simulated time
+static float runPads(uint8_t count, uint32_t &maxPollUs)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        pads[i].taps = 0;
+        pads[i].tx.beginRead(tapBlocks, TAP_BLOCK_COUNT);
+        pads[i].nextCardAt = millis() + i * 50; // players do not arrive in lockstep
+    }
+
+    unsigned long start = millis();
+    uint32_t nextUid = 0x44000000;
+    maxPollUs = 0;
+    while (millis() - start < SIM_MS)
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            Pad &pad = pads[i];
+            if (pad.card == nullptr && (long)(millis() - pad.nextCardAt) >= 0)
+            {
+                pad.card = new FakeCard(nextUid++);
+                pad.mfrc522.fakeInsert(*pad.card);
+            }
+
+            unsigned long pollStart = micros();
+            RFIDTxResult result = pad.tx.poll();
+            maxPollUs = max(maxPollUs, (uint32_t)(micros() - pollStart));
+            if (result == RFIDTxResult::Done)
+            {
+                pad.taps++;
+            }
+            if (result == RFIDTxResult::Done || result == RFIDTxResult::Failed)
+            {
+                pad.mfrc522.PICC_HaltA();
+                pad.mfrc522.fakeRemove(*pad.card);
+                delete pad.card;
+                pad.card = nullptr;
+                pad.nextCardAt = millis() + HANDLING_MS;
+                pad.tx.beginRead(tapBlocks, TAP_BLOCK_COUNT);
+            }
+        }
+        shimAdvanceMicros(LOOP_US);
+    }
+
+    uint32_t taps = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Pad &pad = pads[i];
+        taps += pad.taps;
+        pad.tx.reset();
+        pad.mfrc522.fakeClearField();
+        delete pad.card;
+        pad.card = nullptr;
+    }
+    return taps * 1000.0f / SIM_MS;
+}
+
+void setUp()
+{
+    shimUseRealClock(false);
+    for (byte i = 0; i < 6; i++)
+    {
+        key.keyByte[i] = 0xFF;
+    }
+}
+
+void tearDown()
+{
+}
+
+static void test_taps_per_second_scale_with_pads()
+{
+    cardDetectBegin(pads[0].mfrc522, -1); // polling: the IRQ serves a single pad only
+
+    float rate[MAX_PADS + 1] = {0};
+    for (uint8_t count = 1; count <= MAX_PADS; count++)
+    {
+        uint32_t maxPollUs;
+        rate[count] = runPads(count, maxPollUs);
+
+        char line[96];
+        snprintf(line, sizeof(line), "%u pad(s): %.2f taps/s, longest poll() %u us", (unsigned)count, rate[count],
+                 (unsigned)maxPollUs);
+        TEST_MESSAGE(line);
+
+        // One pad's poll() never holds the bus for more than a reader timeout
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(FAKE_TIMEOUT_US + FAKE_SELECT_US, maxPollUs);
+        if (count > 1)
+        {
+            TEST_ASSERT_TRUE(rate[count] > rate[count - 1]);
+        }
+    }
+    // Card handling dominates a tap, so pads overlap it almost fully
+    TEST_ASSERT_TRUE(rate[MAX_PADS] > 2.5f * rate[1]);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_taps_per_second_scale_with_pads);
+    return UNITY_END();
+}
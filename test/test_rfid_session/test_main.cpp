@@ -0,0 +1,175 @@
+// RFIDSession against the MFRC522 fake: how many Crypto1 auths each tap
+// flow issues. The profile and coin blocks share sector 0, so a whole tap
+// (read-ahead, coins, award) must authenticate once.
+#include <Arduino.h>
+#include <unity.h>
+#include "RFIDSession.h"
+#include "TapBuffer.h"
+#include "CoinStore.h"
+#include "RFIDData.h"
+
+static MFRC522 reader;
+static MFRC522::MIFARE_Key key;
+static uint8_t writtenCalls;
+static MFRC522::Uid writtenUid;
+
+static void onCardWritten(const MFRC522::Uid &uid)
+{
+    writtenCalls++;
+    writtenUid = uid;
+}
+
+static void writeProfile(FakeCard &card, uint8_t bools)
+{
+    ProfileFields fields = {};
+    fields.age = 12;
+    fields.creatureType = 2;
+    fields.bools = bools;
+    strcpy(fields.name, "Flamey");
+    TEST_ASSERT_TRUE(encodeProfile(fields, card.blocks[PROFILE_BLOCK]) == ProfileError::Ok);
+}
+
+static int32_t cardCoins(const FakeCard &card)
+{
+    int32_t coins = 0;
+    TEST_ASSERT_TRUE(decodeValueBlock(card.blocks[COIN_VALUE_BLOCK], coins));
+    return coins;
+}
+
+static void present(FakeCard &card)
+{
+    reader.fakeInsert(card);
+    TEST_ASSERT_TRUE(reader.PICC_IsNewCardPresent());
+    TEST_ASSERT_TRUE(reader.PICC_ReadCardSerial());
+    reader.fakeCounters = {};
+}
+
+void setUp()
+{
+    shimUseRealClock(false);
+    reader.fakeClearField();
+}
+
+void tearDown()
+{
+}
+
+static void test_tap_reads_and_awards_with_one_auth()
+{
+    FakeCard card(0x11223344);
+    writeProfile(card, COINS_IN_VALUE_BLOCK);
+    card.setValueBlock(COIN_VALUE_BLOCK, 10);
+    present(card);
+
+    RFIDSession session(reader, key);
+    session.newTap();
+    TapBuffer tap;
+    TEST_ASSERT_TRUE(readAhead(reader, session, tap));
+    int32_t coins = 0;
+    TEST_ASSERT_TRUE(loadCoins(session, tap.block(PROFILE_BLOCK), tap.block(COIN_VALUE_BLOCK), coins));
+    TEST_ASSERT_EQUAL_INT32(10, coins);
+    TEST_ASSERT_TRUE(awardCoins(session, 5));
+
+    TEST_ASSERT_EQUAL_UINT32(1, reader.fakeCounters.auths);
+    TEST_ASSERT_EQUAL_UINT16(1, session.authCount());
+    TEST_ASSERT_EQUAL_UINT32(2, reader.fakeCounters.reads);
+    TEST_ASSERT_EQUAL_INT32(15, cardCoins(card));
+}
+
+static void test_legacy_migration_stays_in_one_auth()
+{
+    FakeCard card(0x11223345);
+    memcpy(card.blocks[PROFILE_BLOCK], "12400203%Flamey", 16);
+    present(card);
+
+    RFIDSession session(reader, key);
+    session.newTap();
+    TapBuffer tap;
+    TEST_ASSERT_TRUE(readAhead(reader, session, tap));
+    int32_t coins = 0;
+    TEST_ASSERT_TRUE(loadCoins(session, tap.block(PROFILE_BLOCK), tap.block(COIN_VALUE_BLOCK), coins));
+
+    TEST_ASSERT_EQUAL_INT32(40, coins);
+    TEST_ASSERT_EQUAL_INT32(40, cardCoins(card));
+    ProfileFields migrated;
+    TEST_ASSERT_TRUE(decodeProfile(card.blocks[PROFILE_BLOCK], migrated) == ProfileError::Ok);
+    TEST_ASSERT_EQUAL_UINT8(3 | COINS_IN_VALUE_BLOCK, migrated.bools);
+    TEST_ASSERT_EQUAL_UINT32(1, reader.fakeCounters.auths);
+    TEST_ASSERT_EQUAL_UINT32(2, reader.fakeCounters.writes); // value block, then the flagged profile
+}
+
+static void test_commit_authenticates_each_sector_once()
+{
+    FakeCard card(0x11223346);
+    present(card);
+
+    RFIDSession session(reader, key);
+    session.newTap();
+    BlockImage image[4];
+    const byte addrs[4] = {5, 1, 6, 2}; // sectors interleaved
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        image[i].blockAddr = addrs[i];
+        memset(image[i].data, 0xA0 + i, 16);
+    }
+    TEST_ASSERT_TRUE(session.commit(image, 4));
+    TEST_ASSERT_EQUAL_UINT32(2, reader.fakeCounters.auths);
+    TEST_ASSERT_EQUAL_UINT32(4, reader.fakeCounters.writes);
+    TEST_ASSERT_EQUAL_MEMORY(image[2].data, card.blocks[6], 16);
+
+    // The same image again: the shadow skips every block, so no frames at all
+    reader.fakeCounters = {};
+    TEST_ASSERT_TRUE(session.commit(image, 4));
+    TEST_ASSERT_EQUAL_UINT32(0, reader.fakeCounters.frames);
+    TEST_ASSERT_EQUAL_UINT16(4, session.blocksSkipped());
+}
+
+static void test_failed_auth_recovers_with_reselect()
+{
+    FakeCard card(0x11223347);
+    writeProfile(card, COINS_IN_VALUE_BLOCK);
+    card.failAuths = 1;
+    present(card);
+
+    RFIDSession session(reader, key);
+    session.newTap();
+    byte block[16];
+    TEST_ASSERT_FALSE(session.readBlock(PROFILE_BLOCK, block));
+    TEST_ASSERT_TRUE(card.state == FakeCard::Idle); // a failed auth drops the card
+
+    TEST_ASSERT_TRUE(session.reselect());
+    TEST_ASSERT_TRUE(session.readBlock(PROFILE_BLOCK, block));
+    TEST_ASSERT_EQUAL_MEMORY(card.blocks[PROFILE_BLOCK], block, 16);
+    TEST_ASSERT_EQUAL_UINT32(2, reader.fakeCounters.auths);
+}
+
+static void test_only_real_writes_report_the_card_written()
+{
+    FakeCard card(0x11223348);
+    present(card);
+
+    RFIDSession session(reader, key);
+    session.setOnCardWritten(onCardWritten);
+    session.newTap();
+    writtenCalls = 0;
+    byte block[16];
+    memset(block, 0x42, sizeof(block));
+    TEST_ASSERT_TRUE(session.writeBlockIfChanged(PROFILE_BLOCK, block));
+    TEST_ASSERT_EQUAL_UINT8(1, writtenCalls);
+    TEST_ASSERT_EQUAL_MEMORY(card.uid.uidByte, writtenUid.uidByte, 4);
+
+    // Unchanged bytes are skipped, so nothing on the card went stale
+    TEST_ASSERT_TRUE(session.writeBlockIfChanged(PROFILE_BLOCK, block));
+    TEST_ASSERT_EQUAL_UINT8(1, writtenCalls);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tap_reads_and_awards_with_one_auth);
+    RUN_TEST(test_legacy_migration_stays_in_one_auth);
+    RUN_TEST(test_commit_authenticates_each_sector_once);
+    RUN_TEST(test_failed_auth_recovers_with_reselect);
+    RUN_TEST(test_only_real_writes_report_the_card_written);
+    return UNITY_END();
+}
@@ -0,0 +1,141 @@
+// RFIDTransaction against the MFRC522 fake: a read or write that fails
+// part-way resumes through a reselect instead of restarting the tap, and no
+// single poll() holds loop() for longer than one reader timeout.
+#include <Arduino.h>
+#include <unity.h>
+#include "RFIDTransaction.h"
+#include "CardDetect.h"
+#include "RFIDData.h"
+
+#define LOOP_US 1000 // rest of loop() between two poll() calls
+#define POLL_BOUND_US (FAKE_TIMEOUT_US + FAKE_SELECT_US)
+
+static MFRC522 reader;
+static MFRC522::MIFARE_Key key;
+
+// Polls like loop() does until the transaction settles; records the states it went through
+static RFIDTxResult runToEnd(RFIDTransaction &tx, bool &reselected)
+{
+    reselected = false;
+    RFIDTxResult result = RFIDTxResult::InProgress;
+    unsigned long start = micros();
+    while (result == RFIDTxResult::InProgress)
+    {
+        result = tx.poll();
+        reselected |= tx.state() == RFIDTxState::Reselect;
+        shimAdvanceMicros(LOOP_US);
+        TEST_ASSERT_TRUE_MESSAGE(micros() - start < 5000000UL, "transaction never settled");
+    }
+    return result;
+}
+
+void setUp()
+{
+    shimUseRealClock(false);
+    reader.fakeClearField();
+    reader.fakeCounters = {};
+    cardDetectBegin(reader, -1);
+    for (byte i = 0; i < 6; i++)
+    {
+        key.keyByte[i] = 0xFF;
+    }
+}
+
+void tearDown()
+{
+    reader.fakeClearField(); // the cards were locals of the test
+}
+
+static void test_failed_read_resumes_through_reselect()
+{
+    FakeCard card(0x22334455);
+    memset(card.blocks[PROFILE_BLOCK], 0x5A, 16);
+    card.failReads = 1;
+    reader.fakeInsert(card);
+
+    RFIDTransaction tx(reader, key);
+    tx.beginRead(PROFILE_BLOCK);
+    bool reselected = false;
+    TEST_ASSERT_TRUE(runToEnd(tx, reselected) == RFIDTxResult::Done);
+
+    TEST_ASSERT_TRUE(reselected);
+    TEST_ASSERT_EQUAL_MEMORY(card.blocks[PROFILE_BLOCK], tx.data(), 16);
+    TEST_ASSERT_EQUAL_UINT32(2, reader.fakeCounters.auths); // the failed read dropped Crypto1
+    TEST_ASSERT_EQUAL_UINT32(2, reader.fakeCounters.reads);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(POLL_BOUND_US, tx.maxPollUs());
+
+    char line[96];
+    snprintf(line, sizeof(line), "Resumed read: longest poll() %u us", (unsigned)tx.maxPollUs());
+    TEST_MESSAGE(line);
+}
+
+static void test_failed_write_resumes_without_a_new_tap()
+{
+    FakeCard card(0x22334456);
+    card.failWrites = 1;
+    reader.fakeInsert(card);
+
+    RFIDTransaction tx(reader, key);
+    tx.beginRead(PROFILE_BLOCK);
+    bool reselected = false;
+    TEST_ASSERT_TRUE(runToEnd(tx, reselected) == RFIDTxResult::Done);
+
+    // Write back on the card the read selected, as the blank-card path does
+    byte block[16];
+    memset(block, 0xC3, sizeof(block));
+    tx.beginWrite(PROFILE_BLOCK, block);
+    TEST_ASSERT_TRUE(runToEnd(tx, reselected) == RFIDTxResult::Done);
+
+    TEST_ASSERT_TRUE(reselected);
+    TEST_ASSERT_EQUAL_MEMORY(block, card.blocks[PROFILE_BLOCK], 16);
+    TEST_ASSERT_EQUAL_UINT32(2, reader.fakeCounters.writes); // the failed one, then the retry
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(POLL_BOUND_US, tx.maxPollUs());
+}
+
+static void test_gives_up_after_the_retry_limit()
+{
+    FakeCard card(0x22334457);
+    card.failReads = 255;
+    reader.fakeInsert(card);
+
+    RFIDTransaction tx(reader, key);
+    tx.setRetryLimit(2);
+    tx.beginRead(PROFILE_BLOCK);
+    bool reselected = false;
+    TEST_ASSERT_TRUE(runToEnd(tx, reselected) == RFIDTxResult::Failed);
+
+    TEST_ASSERT_TRUE(tx.state() == RFIDTxState::Failed);
+    TEST_ASSERT_TRUE(tx.failure() == RFIDTxFailure::OutOfRetries); // counts towards a reader reset
+    TEST_ASSERT_EQUAL_UINT32(3, reader.fakeCounters.reads); // the first try and two retries
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(POLL_BOUND_US, tx.maxPollUs());
+}
+
+static void test_lifted_card_is_not_a_reader_fault()
+{
+    FakeCard card(0x22334458);
+    card.failReads = 1;
+    reader.fakeInsert(card);
+
+    RFIDTransaction tx(reader, key);
+    tx.beginRead(PROFILE_BLOCK);
+    while (tx.state() != RFIDTxState::Reselect)
+    {
+        TEST_ASSERT_TRUE(tx.poll() == RFIDTxResult::InProgress);
+        shimAdvanceMicros(LOOP_US);
+    }
+    reader.fakeRemove(card); // the player lifts the card before the retry
+
+    bool reselected;
+    TEST_ASSERT_TRUE(runToEnd(tx, reselected) == RFIDTxResult::Failed);
+    TEST_ASSERT_TRUE(tx.failure() == RFIDTxFailure::CardLost);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_failed_read_resumes_through_reselect);
+    RUN_TEST(test_failed_write_resumes_without_a_new_tap);
+    RUN_TEST(test_gives_up_after_the_retry_limit);
+    RUN_TEST(test_lifted_card_is_not_a_reader_fault);
+    return UNITY_END();
+}